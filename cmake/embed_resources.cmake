@@ -0,0 +1,75 @@
+# Generates a source defining `embedded_resources()` with every file and folder under RESOURCES_DIR.
+#
+#   cmake -DRESOURCES_DIR=<dir> -DOUTPUT=<file> -P embed_resources.cmake
+
+file(GLOB_RECURSE paths LIST_DIRECTORIES true RELATIVE "${RESOURCES_DIR}" "${RESOURCES_DIR}/*")
+list(SORT paths)
+
+set(declarations "")
+set(entries "")
+set(hashes "")
+set(index 0)
+
+foreach (path IN LISTS paths)
+    string(REPLACE "\\" "\\\\" literal "${path}")
+    string(REPLACE "\"" "\\\"" literal "${literal}")
+
+    if (IS_DIRECTORY "${RESOURCES_DIR}/${path}")
+        string(APPEND entries "    EmbeddedResource { \"${literal}\", true, {} },\n")
+        string(APPEND hashes "${path}/")
+        continue()
+    endif()
+
+    file(READ "${RESOURCES_DIR}/${path}" content HEX)
+    file(SHA256 "${RESOURCES_DIR}/${path}" hash)
+    string(APPEND hashes "${path}:${hash}")
+
+    if (content STREQUAL "")
+        string(APPEND entries "    EmbeddedResource { \"${literal}\", false, {} },\n")
+        continue()
+    endif()
+
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "'\\\\x\\1'," bytes "${content}")
+    string(APPEND declarations "constexpr char resource${index}[] = { ${bytes} };\n")
+    string(APPEND entries "    EmbeddedResource { \"${literal}\", false, { resource${index}, sizeof resource${index} } },\n")
+    math(EXPR index "${index} + 1")
+endforeach()
+
+list(LENGTH paths count)
+string(SHA256 stamp "${hashes}")
+string(SUBSTRING "${stamp}" 0 16 stamp)
+
+set(source "// Generated by cmake/embed_resources.cmake, do not edit.
+
+#include \"Resources.hpp\"
+
+#include <array>
+
+namespace {
+
+${declarations}
+constexpr std::array<EmbeddedResource, ${count}> RESOURCES {
+${entries}};
+
+}
+
+std::span<EmbeddedResource const> embedded_resources()
+{
+    return RESOURCES;
+}
+
+std::uint64_t embedded_resources_stamp()
+{
+    return 0x${stamp};
+}
+")
+
+# Leaving an identical file alone keeps it from being recompiled.
+if (EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" previous)
+    if (previous STREQUAL source)
+        return()
+    endif()
+endif()
+
+file(WRITE "${OUTPUT}" "${source}")
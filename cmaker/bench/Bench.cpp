@@ -0,0 +1,437 @@
+#include "Catalog.hpp"
+#include "Configuration.hpp"
+#include "Directives.hpp"
+#include "FileWriter.hpp"
+#include "Pack.hpp"
+#include "Plan.hpp"
+#include "Render.hpp"
+#include "ThreadPool.hpp"
+#include "Wildcards.hpp"
+
+#include <benchmark/benchmark.h>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <unistd.h>
+
+namespace {
+
+// The shape of a synthetic data directory: `depth` kinds, each inheriting from the previous one
+// and each providing the same `files` files of about `size` bytes, so every layer but the last is
+// overridden. `density` is the percentage of lines wrapped in a preprocessor directive.
+struct Shape
+{
+    std::int64_t files;
+    std::int64_t size;
+    std::int64_t density;
+    std::int64_t depth;
+
+    auto operator<=>(Shape const&) const = default;
+};
+
+Shape shape_of(benchmark::State const& state)
+{
+    return { .files = state.range(0), .size = state.range(1), .density = state.range(2), .depth = state.range(3) };
+}
+
+std::string make_content(Shape const& shape, std::int64_t file)
+{
+    std::string content {};
+    content.reserve(static_cast<std::size_t>(shape.size) + 64);
+
+    for (std::int64_t line = 0; static_cast<std::int64_t>(content.size()) < shape.size; line += 1)
+    {
+        auto const isDirective = shape.density != 0 && (line * shape.density) % 100 < shape.density;
+
+        if (isDirective) content += "%IF [<|ENV:LANGUAGE|> EQUALS <c++>]:\n";
+        content += fmt::format("    int value_{}_{} = 0; // part of !PROJECT!\n", file, line);
+        if (isDirective) content += "%END\n";
+    }
+
+    return content;
+}
+
+void make_tree(std::filesystem::path const& root, Shape const& shape)
+{
+    namespace fs = std::filesystem;
+
+    std::string kinds {};
+    for (std::int64_t kind = 0; kind < shape.depth; kind += 1)
+    {
+        if (kind != 0) kinds += ",";
+        kinds += kind == 0
+            ? R"({ "name": "kind0", "features": [{ "name": "extra", "optional": true }] })"
+            : fmt::format(R"({{ "name": "kind{}", "inherits": ["kind{}"] }})", kind, kind - 1);
+
+        for (std::int64_t file = 0; file < shape.files; file += 1)
+        {
+            auto const path = root / "templates" / "executable" / fmt::format("kind{}", kind) / "!PROJECT!" / fmt::format("group{}", file / 16) / fmt::format("file{}.cpp", file);
+            fs::create_directories(path.parent_path());
+            std::ofstream(path, std::ios::binary) << make_content(shape, file);
+        }
+    }
+
+    fs::create_directories(root / "features" / "extra");
+    std::ofstream(root / "features" / "extra" / "extra.cmake") << "# extra for !PROJECT!\n";
+
+    std::ofstream(root / "languages.json") << fmt::format(
+        R"({{ "languages": [{{ "name": "c++", "standards": [23], "templates": [{{ "name": "executable", "kinds": [{}] }}] }}] }})",
+        kinds
+    );
+}
+
+struct Fixture
+{
+    std::filesystem::path root;
+    std::optional<Pack> pack;
+    Configuration configuration;
+    std::optional<RenderContext> context;
+    Plan plan;
+
+    ~Fixture()
+    {
+        std::error_code error {};
+        std::filesystem::remove_all(root, error);
+    }
+};
+
+Fixture& fixture_for(Shape const& shape)
+{
+    namespace fs = std::filesystem;
+
+    static std::map<Shape, std::unique_ptr<Fixture>> fixtures {};
+
+    auto& fixture = fixtures[shape];
+    if (fixture != nullptr) return *fixture;
+
+    fixture = std::make_unique<Fixture>();
+    fixture->root = fs::temp_directory_path() / fmt::format("cmaker-bench-{}-{}-{}-{}-{}", ::getpid(), shape.files, shape.size, shape.density, shape.depth);
+    fs::remove_all(fixture->root);
+    make_tree(fixture->root / "data", shape);
+
+    auto pack = Pack::open(fixture->root / "data", fixture->root / "catalog.pack");
+    if (!pack.has_value())
+    {
+        fmt::println(stderr, "{}", pack.error().message());
+        std::abort();
+    }
+    fixture->pack.emplace(std::move(pack).value());
+
+    fixture->configuration = {
+        .name = "bench",
+        .language = "c++",
+        .standard = "23",
+        .type = "executable",
+        .kind = fmt::format("kind{}", shape.depth - 1),
+        .features = { "extra" }
+    };
+    fixture->configuration = configure_project(fixture->configuration, fixture->pack->catalog()).value();
+    fixture->context.emplace(make_render_context(fixture->configuration));
+
+    auto const& graph = *fixture->pack->catalog().find_graph("c++", "executable");
+    fixture->plan = make_plan(*fixture->pack, collect_layers(fixture->configuration, graph), fixture->context->wildcards);
+
+    return *fixture;
+}
+
+std::int64_t planned_bytes(Plan const& plan)
+{
+    std::int64_t bytes = 0;
+    for (auto const& file : plan.files) bytes += static_cast<std::int64_t>(file.entry.content.size());
+    return bytes;
+}
+
+// The file the directive benchmarks render, the first one with any directive when there is one.
+PlannedFile const& directive_file(Plan const& plan)
+{
+    auto const found = std::ranges::find_if(plan.files, [] (PlannedFile const& file) {
+        return needs_preprocessing(file.entry.content);
+    });
+
+    return found != plan.files.end() ? *found : plan.files.front();
+}
+
+void bench_load_catalog(benchmark::State& state)
+{
+    auto const& fixture = fixture_for(shape_of(state));
+
+    for (auto _ : state)
+    {
+        auto catalog = load_catalog(fixture.root / "data" / "languages.json");
+        if (!catalog.has_value()) state.SkipWithError(catalog.error().message().c_str());
+        benchmark::DoNotOptimize(catalog);
+    }
+}
+
+void bench_build_pack(benchmark::State& state)
+{
+    auto const& fixture = fixture_for(shape_of(state));
+    auto const packPath = fixture.root / "rebuilt.pack";
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::filesystem::remove(packPath);
+        state.ResumeTiming();
+
+        auto pack = Pack::open(fixture.root / "data", packPath);
+        if (!pack.has_value()) state.SkipWithError(pack.error().message().c_str());
+        benchmark::DoNotOptimize(pack);
+    }
+
+    state.SetBytesProcessed(state.iterations() * planned_bytes(fixture.plan) * shape_of(state).depth);
+}
+
+void bench_open_pack(benchmark::State& state)
+{
+    auto const& fixture = fixture_for(shape_of(state));
+
+    for (auto _ : state)
+    {
+        auto pack = Pack::open(fixture.root / "data", fixture.root / "catalog.pack");
+        if (!pack.has_value()) state.SkipWithError(pack.error().message().c_str());
+        benchmark::DoNotOptimize(pack);
+    }
+}
+
+// The part of `bench_open_pack` that grows with the number of template files, as every one of them
+// is statted to tell whether the pack is still current.
+void bench_stamp_data_directory(benchmark::State& state)
+{
+    auto const& fixture = fixture_for(shape_of(state));
+
+    for (auto _ : state)
+    {
+        auto stamp = Pack::stamp(fixture.root / "data");
+        if (!stamp.has_value()) state.SkipWithError(stamp.error().message().c_str());
+        benchmark::DoNotOptimize(stamp);
+    }
+
+    state.counters["files"] = static_cast<double>(shape_of(state).files * shape_of(state).depth);
+}
+
+void bench_sanitize_configuration(benchmark::State& state)
+{
+    auto const& fixture = fixture_for(shape_of(state));
+
+    for (auto _ : state)
+    {
+        auto result = sanitize_configuration(fixture.configuration, fixture.pack->catalog());
+        benchmark::DoNotOptimize(result);
+    }
+}
+
+void bench_configure_project(benchmark::State& state)
+{
+    auto const& fixture = fixture_for(shape_of(state));
+
+    for (auto _ : state)
+    {
+        auto configuration = configure_project(fixture.configuration, fixture.pack->catalog());
+        benchmark::DoNotOptimize(configuration);
+    }
+}
+
+void bench_plan_project(benchmark::State& state)
+{
+    auto const& fixture = fixture_for(shape_of(state));
+    auto const& graph = *fixture.pack->catalog().find_graph("c++", "executable");
+
+    for (auto _ : state)
+    {
+        auto plan = make_plan(*fixture.pack, collect_layers(fixture.configuration, graph), fixture.context->wildcards);
+        benchmark::DoNotOptimize(plan);
+    }
+
+    state.SetItemsProcessed(state.iterations() * shape_of(state).files * shape_of(state).depth);
+}
+
+void bench_generate_project(benchmark::State& state)
+{
+    namespace fs = std::filesystem;
+
+    auto const& fixture = fixture_for(shape_of(state));
+    auto const output = fixture.root / "output";
+    fs::create_directories(output);
+
+    auto const previous = fs::current_path();
+    fs::current_path(output);
+
+    ThreadPool pool(static_cast<std::size_t>(state.range(4)));
+
+    for (auto _ : state)
+    {
+        auto result = generate_project(*fixture.pack, fixture.plan, fixture.configuration, *fixture.context, pool);
+        if (!result.has_value()) state.SkipWithError(result.error().message().c_str());
+
+        state.PauseTiming();
+        fs::remove_all(output / fixture.configuration.name);
+        state.ResumeTiming();
+    }
+
+    fs::current_path(previous);
+
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(fixture.plan.files.size()));
+    state.SetBytesProcessed(state.iterations() * planned_bytes(fixture.plan));
+}
+
+void bench_preprocess(benchmark::State& state)
+{
+    auto const& fixture = fixture_for(shape_of(state));
+    auto const& file = directive_file(fixture.plan);
+    auto const source = fixture.plan.source(*fixture.pack, file);
+
+    for (auto _ : state)
+    {
+        auto processed = libpreprocessor::process(source, fixture.context->preprocessor);
+        if (!processed.has_value()) state.SkipWithError(processed.error().message().c_str());
+        benchmark::DoNotOptimize(processed);
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(file.entry.content.size()));
+}
+
+void bench_run_directives(benchmark::State& state)
+{
+    auto const& fixture = fixture_for(shape_of(state));
+    auto const& file = directive_file(fixture.plan);
+
+    for (auto _ : state)
+    {
+        auto processed = run_directives(file.entry.program, file.entry.content, fixture.context->preprocessor.environmentVariables);
+        if (!processed.has_value()) state.SkipWithError(processed.error().message().c_str());
+        benchmark::DoNotOptimize(processed);
+    }
+
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(file.entry.content.size()));
+}
+
+void bench_replace_wildcards(benchmark::State& state)
+{
+    auto const& fixture = fixture_for(shape_of(state));
+
+    for (auto _ : state)
+    {
+        for (auto const& file : fixture.plan.files)
+        {
+            auto replaced = fixture.context->wildcards.replace(file.entry.content);
+            benchmark::DoNotOptimize(replaced);
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * planned_bytes(fixture.plan));
+}
+
+void bench_classify_files(benchmark::State& state)
+{
+    auto const& fixture = fixture_for(shape_of(state));
+
+    for (auto _ : state)
+    {
+        for (auto const& file : fixture.plan.files)
+        {
+            benchmark::DoNotOptimize(is_verbatim(file.entry.content));
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * planned_bytes(fixture.plan));
+}
+
+// Writes the files of a project through one I/O backend, into tmpfs where there is one so that
+// what is measured is the cost of the system calls rather than the disk.
+void bench_write_files(benchmark::State& state)
+{
+    namespace fs = std::filesystem;
+
+    auto const& fixture = fixture_for({ .files = state.range(0), .size = state.range(1), .density = 0, .depth = 1 });
+    auto const backend = state.range(2) != 0 ? IoBackend::URING : IoBackend::BLOCKING;
+
+    auto writer = FileWriter::make(backend);
+    if (writer.backend() != backend)
+    {
+        state.SkipWithError("io_uring isn't available");
+        return;
+    }
+
+    auto const root = (fs::is_directory("/dev/shm") ? fs::path("/dev/shm") : fs::temp_directory_path()) / fmt::format("cmaker-bench-io-{}", ::getpid());
+
+    std::vector<FileWrite> writes {};
+    for (auto const& file : fixture.plan.files)
+    {
+        writes.push_back({ .destination = root / file.destination, .content = file.entry.content, .permissions = file.entry.permissions });
+    }
+
+    ThreadPool pool(static_cast<std::size_t>(state.range(3)));
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        fs::remove_all(root);
+        for (auto const& directory : fixture.plan.directories) fs::create_directories(root / directory);
+        state.ResumeTiming();
+
+        auto result = writer.write(writes, pool);
+        if (!result.has_value()) state.SkipWithError(result.error().message().c_str());
+    }
+
+    fs::remove_all(root);
+
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(writes.size()));
+    state.SetBytesProcessed(state.iterations() * planned_bytes(fixture.plan));
+}
+
+void with_shapes(benchmark::internal::Benchmark* benchmark)
+{
+    benchmark->ArgNames({ "files", "size", "density", "depth" });
+    benchmark->ArgsProduct({ { 16, 256 }, { 1 << 10, 16 << 10 }, { 0, 10 }, { 1, 4 } });
+}
+
+void with_shapes_and_jobs(benchmark::internal::Benchmark* benchmark)
+{
+    std::vector<std::int64_t> jobs { 1 };
+    if (std::thread::hardware_concurrency() > 1) jobs.push_back(std::thread::hardware_concurrency());
+
+    benchmark->ArgNames({ "files", "size", "density", "depth", "jobs" });
+    benchmark->ArgsProduct({ { 16, 256 }, { 1 << 10, 16 << 10 }, { 0, 10 }, { 1, 4 }, jobs });
+    benchmark->UseRealTime();
+}
+
+void with_backends(benchmark::internal::Benchmark* benchmark)
+{
+    std::vector<std::int64_t> jobs { 1 };
+    if (std::thread::hardware_concurrency() > 1) jobs.push_back(std::thread::hardware_concurrency());
+
+    benchmark->ArgNames({ "files", "size", "uring", "jobs" });
+    benchmark->ArgsProduct({ { 256, 2048 }, { 1 << 10, 16 << 10 }, { 0, 1 }, jobs });
+    benchmark->UseRealTime();
+}
+
+}
+
+BENCHMARK(bench_load_catalog)->Apply(with_shapes);
+BENCHMARK(bench_build_pack)->Apply(with_shapes);
+BENCHMARK(bench_open_pack)->Apply(with_shapes);
+BENCHMARK(bench_stamp_data_directory)->Apply(with_shapes);
+BENCHMARK(bench_sanitize_configuration)->Apply(with_shapes);
+BENCHMARK(bench_configure_project)->Apply(with_shapes);
+BENCHMARK(bench_plan_project)->Apply(with_shapes);
+BENCHMARK(bench_generate_project)->Apply(with_shapes_and_jobs);
+BENCHMARK(bench_preprocess)->Apply(with_shapes);
+BENCHMARK(bench_run_directives)->Apply(with_shapes);
+BENCHMARK(bench_replace_wildcards)->Apply(with_shapes);
+BENCHMARK(bench_classify_files)->Apply(with_shapes);
+
+BENCHMARK(bench_write_files)->Apply(with_backends);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,152 @@
+#include "Catalog.hpp"
+#include "Configuration.hpp"
+#include "Directives.hpp"
+#include "Pack.hpp"
+#include "Plan.hpp"
+#include "Render.hpp"
+
+#include <fmt/format.h>
+#include <libpreprocessor/Processor.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+// Renders every template the directive compiler accepts both through its compiled program and
+// through libpreprocessor, for every language, standard, template, kind and set of features the
+// catalog allows, and reports each render where the two disagree. The compiler's grammar was
+// worked out from the templates rather than from libpreprocessor, so this is what holds the fast
+// path to the reference.
+
+namespace {
+
+// Every subset of the features any kind of the template offers. The ones a kind doesn't allow are
+// rejected when configuring.
+std::vector<std::vector<std::string>> feature_sets(Template const& type)
+{
+    std::vector<std::string> names {};
+
+    for (auto const& kind : type.kinds)
+    {
+        for (auto const& feature : kind.features.value_or(std::vector<Feature> {}))
+        {
+            if (std::ranges::find(names, feature.name) == names.end()) names.push_back(feature.name);
+        }
+    }
+
+    std::vector<std::vector<std::string>> sets {};
+
+    for (std::size_t mask = 0; mask < (std::size_t { 1 } << names.size()); mask += 1)
+    {
+        auto& set = sets.emplace_back();
+
+        for (std::size_t index = 0; index < names.size(); index += 1)
+        {
+            if (mask & (std::size_t { 1 } << index)) set.push_back(names[index]);
+        }
+    }
+
+    return sets;
+}
+
+std::string first_difference(std::string_view left, std::string_view right)
+{
+    auto const [leftEnd, rightEnd] = std::ranges::mismatch(left, right);
+    auto const offset = static_cast<std::size_t>(leftEnd - left.begin());
+    auto const line = std::ranges::count(left.substr(0, offset), '\n') + 1;
+
+    auto fnLine = [&] (std::string_view content) {
+        auto const start = content.rfind('\n', offset == 0 ? 0 : offset - 1);
+        auto const from = start == std::string_view::npos || offset == 0 ? 0 : start + 1;
+        return content.substr(from, content.find('\n', from) - from);
+    };
+
+    return fmt::format("line {}:\n    compiled:        \"{}\"\n    libpreprocessor: \"{}\"", line, fnLine(left), fnLine(right));
+}
+
+}
+
+int main(int argc, char const** argv)
+{
+    namespace fs = std::filesystem;
+
+    auto const dataPath = fs::path(argc > 1 ? argv[1] : PROJECT_SOURCE_DIR "/resources");
+    auto const packPath = fs::temp_directory_path() / fmt::format("cmaker-check-{}.pack", ::getpid());
+
+    auto pack = Pack::open(dataPath, packPath);
+
+    std::error_code error {};
+    fs::remove(packPath, error);
+
+    if (!pack.has_value())
+    {
+        fmt::println("{}", pack.error().message());
+        return EXIT_FAILURE;
+    }
+
+    // The same file rendered with the same variables only has to be compared once.
+    std::set<std::string> compared {};
+    std::size_t failures = 0;
+
+    for (auto const& language : pack->catalog().languages())
+    for (auto const standard : language.standards)
+    for (auto const& type : language.templates)
+    for (auto const& kind : type.kinds)
+    for (auto const& features : feature_sets(type))
+    {
+        Configuration const requested {
+            .name = "check",
+            .language = language.name,
+            .standard = std::to_string(standard),
+            .type = type.name,
+            .kind = kind.name,
+            .features = features
+        };
+
+        auto const configuration = configure_project(requested, pack->catalog());
+        if (!configuration.has_value()) continue;
+
+        auto const context = make_render_context(*configuration);
+        auto const& graph = *pack->catalog().find_graph(language.name, type.name);
+        auto const plan = make_plan(*pack, collect_layers(*configuration, graph), context.wildcards);
+        auto const& variables = context.preprocessor.environmentVariables;
+
+        for (auto const& file : plan.files)
+        {
+            if (file.entry.program.empty()) continue;
+
+            auto const source = plan.source(*pack, file);
+
+            auto key = source.generic_string();
+            for (auto const& name : { "ENV:LANGUAGE", "ENV:STANDARD", "ENV:KIND", "ENV:MODE", "ENV:FEATURES" })
+            {
+                key += fmt::format("\n{}={}", name, variables.at(name));
+            }
+
+            if (!compared.insert(key).second) continue;
+
+            auto const compiled = run_directives(file.entry.program, file.entry.content, variables);
+            auto const reference = libpreprocessor::process(source, context.preprocessor);
+
+            if (compiled.has_value() && reference.has_value() && *compiled == *reference) continue;
+            if (!compiled.has_value() && !reference.has_value()) continue;
+
+            failures += 1;
+            fmt::println("{} differs for {} {} {} {} [{}]", source.string(), language.name, standard, type.name, configuration->kind, fmt::join(configuration->features, ","));
+
+            if (!compiled.has_value()) fmt::println("    compiled: {}", compiled.error().message());
+            else if (!reference.has_value()) fmt::println("    libpreprocessor: {}", reference.error().message());
+            else fmt::println("    {}", first_difference(*compiled, *reference));
+        }
+    }
+
+    fmt::println("{} renders compared, {} differ.", compared.size(), failures);
+
+    return failures == 0 && !compared.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Configuration.hpp"
+#include "Pack.hpp"
+#include "Plan.hpp"
+#include "Render.hpp"
+#include "ThreadPool.hpp"
+
+#include <liberror/Result.hpp>
+
+#include <ostream>
+
+// Writes the project, along with its manifest, as a tar archive rooted at the project name instead
+// of creating it on disk. Entries are sorted by path and carry the template permissions, root
+// ownership and a fixed modification time (`SOURCE_DATE_EPOCH` when set, the epoch otherwise), so
+// the same configuration and templates always produce the same archive.
+liberror::Result<void> write_archive(Pack const& pack, Plan const& plan, Configuration const& configuration, RenderContext const& context, ThreadPool& pool, std::ostream& output);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "Configuration.hpp"
+
+#include <liberror/Result.hpp>
+
+#include <filesystem>
+#include <vector>
+
+// Reads the projects of a batch manifest: either a JSON array of objects or one object per line,
+// each holding the same fields as the command line. An entry that doesn't parse is reported in
+// place, so the rest of the batch can still be generated.
+liberror::Result<std::vector<liberror::Result<Configuration>>> load_batch(std::filesystem::path const& path);
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "KindGraph.hpp"
+
+#include <liberror/Result.hpp>
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct Feature
+{
+    std::string name;
+    bool optional;
+    std::optional<std::vector<std::string>> requirez;
+
+    friend void to_json(nlohmann::json& json, Feature const& type)
+    {
+        json["name"] = type.name;
+        json["optional"] = type.optional;
+        if (type.requirez.has_value()) json["requires"] = *type.requirez;
+    }
+
+    friend void from_json(nlohmann::json const& json, Feature& type)
+    {
+        json.at("name").get_to(type.name);
+        json.at("optional").get_to(type.optional);
+        if (json.count("requires")) type.requirez = json.at("requires").get<std::vector<std::string>>();
+    }
+};
+
+struct Kind
+{
+    std::string name;
+    std::optional<std::vector<Feature>> features;
+    std::optional<std::vector<std::string>> inherits;
+
+    friend void to_json(nlohmann::json& json, Kind const& type)
+    {
+        json["name"] = type.name;
+        if (type.features.has_value()) json["features"] = *type.features;
+        if (type.inherits.has_value()) json["inherits"] = *type.inherits;
+    }
+
+    friend void from_json(nlohmann::json const& json, Kind& type)
+    {
+        json.at("name").get_to(type.name);
+        if (json.count("features")) type.features = json.at("features").get<std::vector<Feature>>();
+        if (json.count("inherits")) type.inherits = json.at("inherits").get<std::vector<std::string>>();
+    };
+};
+
+struct Template
+{
+    std::string name;
+    std::vector<Kind> kinds;
+
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Template, name, kinds);
+};
+
+struct Language
+{
+    std::string name;
+    std::vector<int> standards;
+    std::vector<Template> templates;
+
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Language, name, standards, templates);
+};
+
+// Owns the languages described by `languages.json` and indexes them by name, so looking up a
+// language, template or kind is a single hash probe instead of a scan over the whole catalog. The
+// kind graph of every template is resolved up front, which is also where a malformed catalog is
+// rejected.
+class Catalog
+{
+public:
+    static liberror::Result<Catalog> make(std::vector<Language> languages);
+
+    Catalog() = default;
+
+    Catalog(Catalog const&) = delete;
+    Catalog& operator=(Catalog const&) = delete;
+    Catalog(Catalog&&) = default;
+    Catalog& operator=(Catalog&&) = default;
+
+    std::vector<Language> const& languages() const { return m_languages; }
+
+    Language const* find_language(std::string_view language) const;
+    Template const* find_template(std::string_view language, std::string_view type) const;
+    Kind const* find_kind(std::string_view language, std::string_view type, std::string_view kind) const;
+    KindGraph const* find_graph(std::string_view language, std::string_view type) const;
+
+private:
+    std::vector<Language> m_languages {};
+    std::unordered_map<std::string, Language const*> m_languageIndex {};
+    std::unordered_map<std::string, Template const*> m_templateIndex {};
+    std::unordered_map<std::string, Kind const*> m_kindIndex {};
+    std::unordered_map<std::string, KindGraph> m_graphIndex {};
+};
+
+liberror::Result<Catalog> parse_catalog(std::string_view content, std::string_view origin);
+liberror::Result<Catalog> load_catalog(std::filesystem::path const& path);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Catalog.hpp"
+
+#include <liberror/Result.hpp>
+#include <nlohmann/json.hpp>
+
+#include <string>
+#include <vector>
+
+struct Configuration
+{
+    std::string name;
+    std::string language;
+    std::string standard;
+    std::string type;
+    std::string kind;
+    std::vector<std::string> features;
+
+    friend void to_json(nlohmann::json& json, Configuration const& type)
+    {
+        json["name"] = type.name;
+        json["lang"] = type.language;
+        json["std"] = std::stoi(type.standard);
+        json["type"] = type.type;
+        json["kind"] = type.kind;
+        json["features"] = type.features;
+    }
+
+    // Uses the command line's names and defaults, so a manifest entry reads like the arguments it
+    // replaces.
+    friend void from_json(nlohmann::json const& json, Configuration& type)
+    {
+        json.at("name").get_to(type.name);
+        type.language = json.value("lang", "c++");
+        type.standard = std::to_string(json.value("std", 23));
+        type.type = json.value("type", "executable");
+        type.kind = json.value("kind", "common");
+        type.features = json.value("features", std::vector<std::string> {});
+    }
+};
+
+liberror::Result<void> sanitize_configuration(Configuration const& configuration, Catalog const& catalog);
+
+// Checks `configuration` against the catalog and adds every feature its kind requires.
+liberror::Result<Configuration> configure_project(Configuration configuration, Catalog const& catalog);
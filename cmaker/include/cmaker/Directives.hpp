@@ -0,0 +1,43 @@
+#pragma once
+
+#include <liberror/Result.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// One step of a compiled template. Texts, variables and literals are spans of the template the
+// program was compiled from, so a program is plain data that can live in the pack as is.
+struct Instruction
+{
+    enum Operation : std::uint32_t
+    {
+        TEXT,     // emit [first, first + second)
+        JUMP,     // continue at `first`
+        BRANCH,   // evaluate the `second` instructions that follow, continue at `first` when false
+        VARIABLE, // push the value of the variable named [first, first + second)
+        LITERAL,  // push [first, first + second)
+        EQUALS,
+        CONTAINS,
+        AND,
+        OR,
+        NOT
+    };
+
+    std::uint32_t operation;
+    std::uint32_t first;
+    std::uint32_t second;
+};
+
+// Compiles the `%IF`, `%ELSE`, `%SWITCH`, `%CASE`, `%DEFAULT` and `%END` directives and the `@`
+// indentation markers of a template into a program that is evaluated without parsing anything
+// again. Returns nothing when the template uses anything else, in which case it has to go through
+// libpreprocessor. The grammar follows the shipped templates rather than the library, so programs
+// are only run when asked to; `cmaker_check_directives` checks that both render them alike.
+std::optional<std::vector<Instruction>> compile_directives(std::string_view content);
+
+liberror::Result<std::string> run_directives(std::span<Instruction const> program, std::string_view content, std::unordered_map<std::string, std::string> const& variables);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "ThreadPool.hpp"
+
+#include <liberror/Result.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+
+enum class IoBackend
+{
+    BLOCKING,
+    URING
+};
+
+struct FileWrite
+{
+    std::filesystem::path destination;
+    std::string_view content;
+    std::filesystem::perms permissions;
+    // The template file `content` was read from unchanged, if any, which is cloned instead of
+    // writing the bytes out again.
+    std::filesystem::path source {};
+};
+
+// Creates a batch of new files, failing for any that already exists, with exactly the given
+// content and permissions whatever the umask.
+//
+// The blocking backend writes every file with its own open, write and close from the pool's
+// workers. The io_uring backend queues those three as linked requests for many files at once, so
+// a whole batch costs a handful of system calls, which is what matters where every call is a round
+// trip, e.g. on network filesystems. Files with a source are still cloned one by one from the pool
+// first, and only written through the ring when cloning fails. On local disks the ring is slower
+// than the pool, which is why blocking is the default.
+class FileWriter
+{
+public:
+    // Falls back to the blocking backend when io_uring can't be used: kernels older than 5.15, or
+    // io_uring disabled by sysctl or a seccomp filter.
+    static FileWriter make(IoBackend backend);
+
+    FileWriter(FileWriter&& other) noexcept;
+    FileWriter& operator=(FileWriter&& other) noexcept;
+    ~FileWriter();
+
+    IoBackend backend() const { return m_ring != nullptr ? IoBackend::URING : IoBackend::BLOCKING; }
+
+    // Returns the error of the first file, in batch order, that couldn't be written.
+    liberror::Result<void> write(std::span<FileWrite const> files, ThreadPool& pool);
+
+private:
+    struct Ring;
+
+    FileWriter() = default;
+
+    liberror::Result<void> write_blocking(std::span<FileWrite const> files, ThreadPool& pool);
+    liberror::Result<void> write_uring(std::span<FileWrite const> files, ThreadPool& pool);
+
+    std::unique_ptr<Ring> m_ring {};
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// 64-bit FNV-1a. Only used to tell contents apart, never for anything that has to resist
+// collisions on purpose.
+inline std::uint64_t hash(std::string_view bytes, std::uint64_t seed = 14695981039346656037ull)
+{
+    for (auto const byte : bytes)
+    {
+        seed ^= static_cast<unsigned char>(byte);
+        seed *= 1099511628211ull;
+    }
+
+    return seed;
+}
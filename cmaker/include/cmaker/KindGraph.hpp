@@ -0,0 +1,90 @@
+#pragma once
+
+#include <liberror/Result.hpp>
+
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+struct Kind;
+struct Template;
+
+class IndexSet
+{
+public:
+    IndexSet() = default;
+    explicit IndexSet(std::size_t size) : m_words((size + 63) / 64, 0) {}
+
+    void insert(std::size_t index) { m_words[index / 64] |= std::uint64_t { 1 } << (index % 64); }
+    bool contains(std::size_t index) const { return (m_words[index / 64] >> (index % 64)) & 1; }
+
+    IndexSet& operator|=(IndexSet const& other)
+    {
+        for (std::size_t word = 0; word < m_words.size(); word += 1) m_words[word] |= other.m_words[word];
+        return *this;
+    }
+
+    template <class Fn>
+    void for_each(Fn&& fn) const
+    {
+        for (std::size_t word = 0; word < m_words.size(); word += 1)
+        {
+            for (auto bits = m_words[word]; bits != 0; bits &= bits - 1)
+            {
+                fn(word * 64 + static_cast<std::size_t>(std::countr_zero(bits)));
+            }
+        }
+    }
+
+    std::vector<std::size_t> elements() const
+    {
+        std::vector<std::size_t> elements {};
+        for_each([&] (std::size_t index) { elements.push_back(index); });
+        return elements;
+    }
+
+private:
+    std::vector<std::uint64_t> m_words {};
+};
+
+// The kinds of a template with their `inherits` and feature `requires` relations resolved once.
+// Kinds are kept in topological order (every kind after the kinds it inherits from) and each kind
+// has its available features, required features and per-feature requirements precomputed as
+// bitsets, so all the questions the generator asks about a kind are answered without walking
+// the hierarchy again.
+class KindGraph
+{
+public:
+    using Index = std::size_t;
+
+    static liberror::Result<KindGraph> build(Template const& projectTemplate);
+
+    std::optional<Index> find_kind(std::string_view name) const;
+    Kind const& kind(Index kind) const { return *m_kinds[kind]; }
+
+    // The kinds `kind` inherits from, directly or not, followed by `kind` itself.
+    std::span<Index const> lineage(Index kind) const { return m_lineages[kind]; }
+
+    bool is_available(Index kind, std::string_view feature) const;
+
+    // The requested features, each preceded by the features it requires, followed by the features
+    // the kind or its ancestors always install.
+    std::vector<std::string> resolve_features(Index kind, std::span<std::string const> requested) const;
+
+private:
+    std::optional<Index> find_feature(std::string_view name) const;
+
+    std::vector<Kind const*> m_kinds {};
+    std::unordered_map<std::string_view, Index> m_kindIndex {};
+    std::vector<std::string_view> m_features {};
+    std::unordered_map<std::string_view, Index> m_featureIndex {};
+    std::vector<std::vector<Index>> m_lineages {};
+    std::vector<IndexSet> m_available {};
+    std::vector<IndexSet> m_required {};
+    std::vector<std::vector<IndexSet>> m_requirements {};
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Configuration.hpp"
+#include "Plan.hpp"
+
+#include <liberror/Result.hpp>
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <span>
+#include <string>
+
+struct ManifestFile
+{
+    std::string source;
+    std::uint64_t context;
+    std::uint64_t content;
+    std::uint64_t output;
+
+    friend void to_json(nlohmann::json& json, ManifestFile const& type)
+    {
+        json["source"] = type.source;
+        json["context"] = type.context;
+        json["content"] = type.content;
+        json["output"] = type.output;
+    }
+
+    friend void from_json(nlohmann::json const& json, ManifestFile& type)
+    {
+        json.at("source").get_to(type.source);
+        json.at("context").get_to(type.context);
+        json.at("content").get_to(type.content);
+        json.at("output").get_to(type.output);
+    }
+};
+
+// Stored at the root of every generated project. It records the configuration the project was
+// generated with and, for every file, where it came from and hashes of the template, the render
+// context and the output, which is all `update` needs to tell which files are out of date and
+// which ones were modified by hand.
+struct Manifest
+{
+    static constexpr auto FILE_NAME = ".cmaker.json";
+
+    Configuration configuration;
+    std::map<std::string, ManifestFile> files;
+
+    friend void to_json(nlohmann::json& json, Manifest const& type)
+    {
+        json["configuration"] = type.configuration;
+        json["files"] = type.files;
+    }
+
+    friend void from_json(nlohmann::json const& json, Manifest& type)
+    {
+        json.at("configuration").get_to(type.configuration);
+        json.at("files").get_to(type.files);
+    }
+};
+
+// Everything a file's rendering depends on besides the template itself.
+std::uint64_t hash_context(Configuration const& configuration);
+
+Manifest make_manifest(Configuration const& configuration, Plan const& plan, std::span<std::uint64_t const> outputs);
+
+std::string serialize_manifest(Manifest const& manifest);
+
+liberror::Result<Manifest> load_manifest(std::filesystem::path const& project);
+liberror::Result<void> save_manifest(Manifest const& manifest, std::filesystem::path const& project);
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Catalog.hpp"
+#include "Directives.hpp"
+
+#include <liberror/Result.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct PackEntry
+{
+    std::string_view path;
+    std::filesystem::perms permissions;
+    bool directory;
+    // Neither preprocessed nor containing any wildcard, so it is copied to the project as is.
+    bool verbatim;
+    // Compiled into the executable, so there is no file of it in the data directory.
+    bool embedded;
+    std::string_view content;
+    std::uint64_t hash;
+    // The compiled directives of a template, empty when it has none or uses something only
+    // libpreprocessor understands. Only used when rendering with `compiledDirectives`.
+    std::span<Instruction const> program;
+};
+
+// A single memory-mapped file holding the parsed catalog together with every file of the
+// `templates/` and `features/` trees. Files are grouped by layer (`templates/<type>/<kind>` and
+// `features/<feature>`) and layers are found through an open-addressing hash table stored in the
+// pack itself, so nothing has to be parsed or walked to start generating a project.
+//
+// The pack is a cache of the data directory: it is rebuilt whenever the size or modification time
+// of any source file differs from the ones it was built from. Checking that is the one part of
+// opening a pack that still walks the data directory, see `stamp`.
+class Pack
+{
+public:
+    static liberror::Result<Pack> open(std::filesystem::path const& dataPath, std::filesystem::path const& packPath);
+
+    // Hashes the type, size and modification time of every source file. Statting the layer folders
+    // alone would be cheaper, but a folder's modification time only changes when entries are added,
+    // removed or renamed in it, so templates edited in place would go unnoticed.
+    static liberror::Result<std::uint64_t> stamp(std::filesystem::path const& dataPath);
+
+    Pack(Pack&& other) noexcept;
+    Pack& operator=(Pack&& other) noexcept;
+    ~Pack();
+
+    Pack(Pack const&) = delete;
+    Pack& operator=(Pack const&) = delete;
+
+    Catalog const& catalog() const { return m_catalog; }
+    std::filesystem::path const& data_path() const { return m_dataPath; }
+
+    // Returns nothing when no such layer exists. The records are checked when the pack is loaded,
+    // so a damaged pack is rebuilt rather than read with templates missing.
+    std::optional<std::vector<PackEntry>> layer(std::string_view root) const;
+
+private:
+    struct Layout
+    {
+        std::uint64_t layerCapacity;
+        std::uint64_t layersOffset;
+        std::uint64_t entriesOffset;
+        std::uint64_t entryCount;
+        std::uint64_t stringsOffset;
+        std::uint64_t stringsSize;
+        std::uint64_t blobOffset;
+        std::uint64_t blobSize;
+        std::uint64_t programsOffset;
+        std::uint64_t programsSize;
+    };
+
+    Pack() = default;
+
+    static liberror::Result<Pack> map(std::filesystem::path const& dataPath, std::filesystem::path const& packPath, std::uint64_t stamp);
+
+    liberror::Result<void> load(std::uint64_t stamp);
+    std::string_view bytes(std::uint64_t offset, std::uint64_t size) const;
+    // Whether every layer and entry record points inside the sections it refers to.
+    bool is_consistent() const;
+
+    std::filesystem::path m_dataPath {};
+    std::string m_image {};
+    char const* m_data { nullptr };
+    std::size_t m_size { 0 };
+    bool m_mapped { false };
+    Layout m_layout {};
+    Catalog m_catalog {};
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Configuration.hpp"
+#include "KindGraph.hpp"
+#include "Pack.hpp"
+#include "Wildcards.hpp"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct PlannedFile
+{
+    std::size_t layer;
+    PackEntry entry;
+    std::filesystem::path destination;
+};
+
+// Where every file of a project comes from once all of its layers are stacked: the inherited
+// kinds in lineage order, each followed by its features. A path provided by several layers is
+// planned once, from the last layer that provides it.
+struct Plan
+{
+    std::vector<std::string> layers;
+    std::vector<std::filesystem::path> directories;
+    std::vector<PlannedFile> files;
+
+    std::filesystem::path source(Pack const& pack, PlannedFile const& file) const
+    {
+        return pack.data_path() / layers[file.layer] / file.entry.path;
+    }
+};
+
+std::vector<std::string> collect_layers(Configuration const& configuration, KindGraph const& graph);
+Plan make_plan(Pack const& pack, std::vector<std::string> layers, WildcardMatcher const& wildcards);
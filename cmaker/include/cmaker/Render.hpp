@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Configuration.hpp"
+#include "FileWriter.hpp"
+#include "Pack.hpp"
+#include "Plan.hpp"
+#include "ThreadPool.hpp"
+#include "Wildcards.hpp"
+
+#include <liberror/Result.hpp>
+#include <libpreprocessor/Processor.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Preprocessed template files shared by every project generated in one run. Outputs are keyed by
+// the file and the whole preprocessor environment, so projects that differ only by name
+// preprocess each file once.
+class PreprocessorCache
+{
+public:
+    liberror::Result<std::string_view> process(std::filesystem::path const& source, libpreprocessor::PreprocessorContext const& context);
+
+private:
+    std::mutex m_mutex {};
+    std::unordered_map<std::string, std::string> m_outputs {};
+};
+
+struct RenderOptions
+{
+    bool linkVerbatim { false };
+    IoBackend io { IoBackend::BLOCKING };
+    PreprocessorCache* preprocessed { nullptr };
+    // Evaluates the directives compiled into the pack instead of handing templates to
+    // libpreprocessor, for the ones `compile_directives` understands.
+    bool compiledDirectives { false };
+};
+
+struct RenderContext
+{
+    libpreprocessor::PreprocessorContext preprocessor;
+    WildcardMatcher wildcards;
+    RenderOptions options;
+};
+
+RenderContext make_render_context(Configuration const& configuration, RenderOptions const& options = {});
+
+bool needs_preprocessing(std::string_view content);
+
+// Whether `content` comes out of rendering unchanged whatever the configuration, which is decided
+// once when the pack is built.
+bool is_verbatim(std::string_view content);
+
+liberror::Result<std::string> render_content(PackEntry const& entry, std::filesystem::path const& source, RenderContext const& context);
+
+// Renders every file on the pool and then writes them all as one batch through the I/O backend of
+// the options. Returns the hash of what was written for every planned file.
+liberror::Result<std::vector<std::uint64_t>> render_plan(Pack const& pack, Plan const& plan, std::filesystem::path const& destination, RenderContext const& context, ThreadPool& pool);
+
+// Renders the project, along with its manifest, into a staging directory next to where it goes
+// and publishes it with a single rename, so the project is either left untouched or complete.
+liberror::Result<void> generate_project(Pack const& pack, Plan const& plan, Configuration const& configuration, RenderContext const& context, ThreadPool& pool);
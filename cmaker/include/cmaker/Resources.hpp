@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+struct EmbeddedResource
+{
+    std::string_view path;
+    bool directory;
+    std::string_view content;
+};
+
+// The `resources/` tree compiled into the executable when it is built with EMBED_RESOURCES, empty
+// otherwise. The stamp changes whenever any of the resources does.
+std::span<EmbeddedResource const> embedded_resources();
+std::uint64_t embedded_resources_stamp();
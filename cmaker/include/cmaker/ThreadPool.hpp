@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// A fixed set of workers with one task queue each. Idle workers steal from the back of the other
+// queues, so a batch of unevenly sized files still keeps every core busy. The calling thread
+// always takes part as worker 0, which makes a pool of size 1 run everything serially in place.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(std::size_t size);
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    std::size_t size() const { return m_queues.size(); }
+
+    // Calls `task` once for every index in [0, count) and returns when all of them are done.
+    void for_each(std::size_t count, std::function<void(std::size_t)> const& task);
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    std::optional<std::size_t> pop(std::size_t worker);
+    void work(std::size_t worker);
+
+    std::vector<std::unique_ptr<Queue>> m_queues {};
+    std::vector<std::jthread> m_threads {};
+    std::atomic<std::function<void(std::size_t)> const*> m_task { nullptr };
+    std::mutex m_mutex {};
+    std::condition_variable m_wakeup {};
+    std::condition_variable m_done {};
+    std::size_t m_generation { 0 };
+    std::size_t m_remaining { 0 };
+    bool m_stopping { false };
+};
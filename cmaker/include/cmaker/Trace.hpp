@@ -0,0 +1,111 @@
+#pragma once
+
+#include <liberror/Result.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Collects spans into a Chrome trace (the JSON format Perfetto and chrome://tracing open). Only
+// one tracer can be active at a time, and when none is, a TraceSpan costs a single branch.
+class Tracer
+{
+public:
+    struct Event
+    {
+        std::string name;
+        std::string detail;
+        std::int64_t thread;
+        double start;
+        double duration;
+        std::uint64_t bytes;
+        std::int64_t bytesRead;
+        std::int64_t bytesWritten;
+        std::int64_t readCalls;
+        std::int64_t writeCalls;
+    };
+
+    Tracer();
+    ~Tracer();
+
+    Tracer(Tracer const&) = delete;
+    Tracer& operator=(Tracer const&) = delete;
+
+    static Tracer* active() { return s_active; }
+
+    double now() const;
+    void record(Event event);
+
+    liberror::Result<void> save(std::filesystem::path const& path) const;
+
+private:
+    static inline Tracer* s_active { nullptr };
+
+    std::chrono::steady_clock::time_point m_start {};
+    mutable std::mutex m_mutex {};
+    std::vector<Event> m_events {};
+};
+
+// Times the enclosing scope. The I/O figures come from the thread's own counters in
+// `/proc/thread-self/io`, with the reads of that file by this span and any nested one taken
+// out, so they cover whatever the scope did through read(2) and write(2), whichever code did it.
+//
+// Those are the only calls counted. Opening, statting, mapping, renaming and cloning files don't
+// show up, and neither does anything submitted through io_uring, whose reads and writes the
+// kernel performs outside of the calling thread's counters.
+class TraceSpan
+{
+public:
+    explicit TraceSpan(char const* name, std::string_view detail = {})
+        : m_tracer(Tracer::active())
+        , m_name(name)
+        , m_detail(detail)
+    {
+        if (m_tracer != nullptr) begin();
+    }
+
+    ~TraceSpan()
+    {
+        if (m_tracer != nullptr) end();
+    }
+
+    TraceSpan(TraceSpan const&) = delete;
+    TraceSpan& operator=(TraceSpan const&) = delete;
+
+    void set_bytes(std::uint64_t bytes) { m_bytes = bytes; }
+
+private:
+    struct Counters
+    {
+        std::int64_t bytesRead;
+        std::int64_t bytesWritten;
+        std::int64_t readCalls;
+        std::int64_t writeCalls;
+        bool valid;
+    };
+
+    struct Overhead
+    {
+        std::int64_t bytesRead;
+        std::int64_t readCalls;
+    };
+
+    static Counters sample();
+
+    void begin();
+    void end();
+
+    static inline thread_local Overhead s_overhead {};
+
+    Tracer* m_tracer;
+    char const* m_name;
+    std::string_view m_detail;
+    std::uint64_t m_bytes { 0 };
+    double m_start { 0 };
+    Counters m_counters {};
+    Overhead m_overhead {};
+};
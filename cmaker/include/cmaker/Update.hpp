@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Manifest.hpp"
+#include "Pack.hpp"
+#include "Plan.hpp"
+#include "Render.hpp"
+#include "ThreadPool.hpp"
+
+#include <liberror/Result.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class Outcome
+{
+    UNCHANGED,
+    UPDATED,
+    SKIPPED
+};
+
+struct FileUpdate
+{
+    Outcome outcome;
+    std::optional<ManifestFile> record;
+};
+
+struct UpdateReport
+{
+    std::vector<std::string> updated;
+    std::vector<std::string> skipped;
+};
+
+// Brings an existing project in line with `plan`. A file is only rendered again when its
+// template, its layer or the render context changed since the manifest was written, and it is
+// only written when that changed its output. Files that were edited by hand, or that cmaker never
+// generated, are left alone and reported as skipped.
+liberror::Result<UpdateReport> update_project(Pack const& pack, Plan const& plan, Configuration const& configuration, Manifest const& manifest, std::filesystem::path const& project, RenderContext const& context, ThreadPool& pool);
+
+// The rules `update_project` applies to every file, for callers that bring single files up to
+// date. `current` describes the file as it is planned now, with the output left out, and
+// `recorded` is its entry in the manifest, if any.
+liberror::Result<FileUpdate> update_file(PlannedFile const& file, ManifestFile current, ManifestFile const* recorded, std::filesystem::path const& source, std::filesystem::path const& destination, RenderContext const& context);
+
+std::optional<std::uint64_t> hash_file(std::filesystem::path const& path);
+
+// Writes `content` next to `path` and renames it over it, so readers see either file whole.
+liberror::Result<void> replace_file(std::filesystem::path const& path, std::string_view content, std::filesystem::perms permissions);
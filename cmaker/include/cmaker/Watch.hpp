@@ -0,0 +1,20 @@
+#pragma once
+
+#include "Configuration.hpp"
+#include "Render.hpp"
+#include "ThreadPool.hpp"
+
+#include <liberror/Result.hpp>
+
+#include <filesystem>
+
+// Keeps a preview project in line with the templates it is generated from, for template authors.
+// The project is created, or updated when it already exists, and then `languages.json` and every
+// layer the project is made of are watched with inotify.
+//
+// Editing a template file renders again only the project file it provides, straight from the data
+// directory, without rebuilding the pack. Adding, removing or renaming files, or editing the
+// catalog, rebuilds the pack and updates the whole project, removing the files no layer provides
+// anymore. Files edited by hand in the preview are left alone, like `update` does. Only returns
+// on errors that leave nothing to watch.
+liberror::Result<void> watch_project(Configuration const& requested, std::filesystem::path const& dataPath, std::filesystem::path const& packPath, RenderOptions const& options, ThreadPool& pool);
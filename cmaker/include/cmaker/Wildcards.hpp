@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Replaces every wildcard of a set in a single left-to-right scan. The patterns are compiled into
+// an Aho-Corasick automaton with all failure transitions resolved up front, so each input byte
+// costs one table lookup. When two matches overlap, the one that ends first wins, which for
+// `!NAME!` style wildcards is the same as the leftmost one.
+class WildcardMatcher
+{
+public:
+    WildcardMatcher() = default;
+    explicit WildcardMatcher(std::unordered_map<std::string, std::string> const& wildcards);
+
+    std::string replace(std::string_view content) const;
+
+    bool matches(std::string_view content) const;
+
+private:
+    static constexpr std::uint32_t NO_MATCH = UINT32_MAX;
+
+    struct Match
+    {
+        std::size_t end;
+        std::uint32_t wildcard;
+    };
+
+    std::size_t skip(std::string_view content, std::size_t position) const;
+    std::vector<Match> scan(std::string_view content) const;
+
+    std::vector<std::array<std::uint32_t, 256>> m_transitions { {} };
+    std::vector<std::uint32_t> m_matches { NO_MATCH };
+    std::vector<std::string> m_patterns {};
+    std::vector<std::string> m_replacements {};
+    std::array<bool, 256> m_firstBytes {};
+    int m_prefilter { -1 };
+};
@@ -0,0 +1,269 @@
+#include "Archive.hpp"
+
+#include "Hash.hpp"
+#include "Manifest.hpp"
+#include "Trace.hpp"
+
+#include <liberror/Try.hpp>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t BLOCK_SIZE = 512;
+
+struct Header
+{
+    std::array<char, 100> name;
+    std::array<char, 8> mode;
+    std::array<char, 8> uid;
+    std::array<char, 8> gid;
+    std::array<char, 12> size;
+    std::array<char, 12> mtime;
+    std::array<char, 8> checksum;
+    char type;
+    std::array<char, 100> linkName;
+    std::array<char, 6> magic;
+    std::array<char, 2> version;
+    std::array<char, 32> userName;
+    std::array<char, 32> groupName;
+    std::array<char, 8> deviceMajor;
+    std::array<char, 8> deviceMinor;
+    std::array<char, 155> prefix;
+    std::array<char, 12> padding;
+};
+
+static_assert(sizeof(Header) == BLOCK_SIZE);
+
+template <std::size_t N>
+bool write_octal(std::array<char, N>& field, std::uint64_t value)
+{
+    // The last byte stays a NUL terminator.
+    field.fill('0');
+    field.back() = '\0';
+
+    for (auto digit = N - 1; digit > 0; digit -= 1)
+    {
+        field[digit - 1] = static_cast<char>('0' + (value & 7));
+        value >>= 3;
+    }
+
+    return value == 0;
+}
+
+template <std::size_t N>
+void write_text(std::array<char, N>& field, std::string_view value)
+{
+    std::memcpy(field.data(), value.data(), std::min(value.size(), N));
+}
+
+std::uint64_t modification_time()
+{
+    auto const* epoch = std::getenv("SOURCE_DATE_EPOCH");
+    if (epoch == nullptr) return 0;
+
+    std::uint64_t value {};
+    auto const [end, error] = std::from_chars(epoch, epoch + std::strlen(epoch), value);
+    return error == std::errc {} && *end == '\0' ? value : 0;
+}
+
+class ArchiveWriter
+{
+public:
+    explicit ArchiveWriter(std::ostream& output) : m_output(output), m_mtime(modification_time()) {}
+
+    liberror::Result<void> directory(std::string const& path)
+    {
+        return entry(path + "/", '5', 0755, {});
+    }
+
+    liberror::Result<void> file(std::string const& path, std::filesystem::perms permissions, std::string_view content)
+    {
+        return entry(path, '0', static_cast<std::uint32_t>(permissions & std::filesystem::perms::mask), content);
+    }
+
+    liberror::Result<void> finish()
+    {
+        static constexpr std::array<char, 2 * BLOCK_SIZE> end {};
+        m_output.write(end.data(), end.size());
+        m_output.flush();
+
+        if (!m_output) return liberror::make_error("Couldn't write the archive.");
+
+        return {};
+    }
+
+private:
+    // Paths that don't fit the name and prefix fields of a ustar header are carried by a pax
+    // extended header instead.
+    liberror::Result<void> entry(std::string const& path, char type, std::uint32_t mode, std::string_view content)
+    {
+        Header header {};
+        write_text(header.magic, "ustar");
+        write_text(header.version, "00");
+        write_octal(header.mode, mode);
+        write_octal(header.uid, 0);
+        write_octal(header.gid, 0);
+        write_octal(header.mtime, m_mtime);
+        header.type = type;
+
+        if (!write_octal(header.size, content.size()))
+        {
+            return liberror::make_error("\"{}\" is too large to be archived.", path);
+        }
+
+        if (!split_path(header, path))
+        {
+            auto record = " path=" + path + "\n";
+            auto length = record.size();
+            while (std::to_string(length).size() + record.size() != length) length = std::to_string(length).size() + record.size();
+            record = std::to_string(length) + record;
+
+            Header extended = header;
+            extended.name = {};
+            extended.prefix = {};
+            write_text(extended.name, "././@PaxHeader");
+            write_octal(extended.size, record.size());
+            extended.type = 'x';
+            block(extended, record);
+
+            write_text(header.name, path.substr(0, header.name.size()));
+        }
+
+        block(header, content);
+
+        if (!m_output) return liberror::make_error("Couldn't write the archive.");
+
+        return {};
+    }
+
+    static bool split_path(Header& header, std::string_view path)
+    {
+        if (path.size() <= header.name.size())
+        {
+            write_text(header.name, path);
+            return true;
+        }
+
+        // Trailing slashes of directories belong to the name, so the split never happens there.
+        for (auto slash = path.rfind('/', path.size() - 2); slash != std::string_view::npos && slash != 0; slash = path.rfind('/', slash - 1))
+        {
+            if (path.size() - slash - 1 > header.name.size()) break;
+            if (slash > header.prefix.size()) continue;
+
+            write_text(header.prefix, path.substr(0, slash));
+            write_text(header.name, path.substr(slash + 1));
+            return true;
+        }
+
+        return false;
+    }
+
+    void block(Header& header, std::string_view content)
+    {
+        header.checksum.fill(' ');
+
+        std::uint32_t checksum = 0;
+        for (auto const byte : std::string_view(reinterpret_cast<char const*>(&header), sizeof header))
+        {
+            checksum += static_cast<unsigned char>(byte);
+        }
+
+        write_octal(header.checksum, checksum);
+        header.checksum.back() = ' ';
+
+        static constexpr std::array<char, BLOCK_SIZE> padding {};
+        m_output.write(reinterpret_cast<char const*>(&header), sizeof header);
+        m_output.write(content.data(), static_cast<std::streamsize>(content.size()));
+        m_output.write(padding.data(), static_cast<std::streamsize>((BLOCK_SIZE - content.size() % BLOCK_SIZE) % BLOCK_SIZE));
+    }
+
+    std::ostream& m_output;
+    std::uint64_t m_mtime;
+};
+
+}
+
+liberror::Result<void> write_archive(Pack const& pack, Plan const& plan, Configuration const& configuration, RenderContext const& context, ThreadPool& pool, std::ostream& output)
+{
+    TraceSpan span("archive");
+
+    // Verbatim files are written straight from the pack, everything else is rendered in memory.
+    std::vector<liberror::Result<std::string>> rendered(plan.files.size());
+    pool.for_each(plan.files.size(), [&] (std::size_t index) {
+        auto const& file = plan.files[index];
+        if (file.entry.verbatim) return;
+
+        TraceSpan renderSpan("render", file.entry.path);
+        renderSpan.set_bytes(file.entry.content.size());
+        rendered[index] = render_content(file.entry, plan.source(pack, file), context);
+    });
+
+    std::vector<std::string> contents(plan.files.size());
+    std::vector<std::uint64_t> outputs {};
+    outputs.reserve(plan.files.size());
+
+    for (std::size_t index = 0; index < plan.files.size(); index += 1)
+    {
+        auto const& file = plan.files[index];
+        if (!file.entry.verbatim) contents[index] = TRY(std::move(rendered[index]));
+        outputs.push_back(file.entry.verbatim ? file.entry.hash : hash(contents[index]));
+    }
+
+    auto const manifest = serialize_manifest(make_manifest(configuration, plan, outputs));
+
+    std::filesystem::path const root = configuration.name;
+
+    std::set<std::string> directories { root.generic_string() };
+    auto fnParents = [&] (std::filesystem::path const& path) {
+        for (auto parent = (root / path).parent_path(); parent != root && !parent.empty(); parent = parent.parent_path())
+        {
+            directories.insert(parent.generic_string());
+        }
+    };
+
+    for (auto const& directory : plan.directories)
+    {
+        directories.insert((root / directory).generic_string());
+        fnParents(directory);
+    }
+
+    std::vector<std::pair<std::string, std::size_t>> files {};
+    files.reserve(plan.files.size());
+
+    for (std::size_t index = 0; index < plan.files.size(); index += 1)
+    {
+        files.emplace_back((root / plan.files[index].destination).generic_string(), index);
+        fnParents(plan.files[index].destination);
+    }
+
+    std::ranges::sort(files);
+
+    TraceSpan writeSpan("write archive");
+    ArchiveWriter writer(output);
+
+    for (auto const& directory : directories)
+    {
+        TRY(writer.directory(directory));
+    }
+
+    for (auto const& [path, index] : files)
+    {
+        auto const& file = plan.files[index];
+        auto const content = file.entry.verbatim ? file.entry.content : std::string_view(contents[index]);
+        TRY(writer.file(path, file.entry.permissions, content));
+    }
+
+    TRY(writer.file((root / Manifest::FILE_NAME).generic_string(), std::filesystem::perms::owner_read | std::filesystem::perms::owner_write | std::filesystem::perms::group_read | std::filesystem::perms::others_read, manifest));
+
+    return writer.finish();
+}
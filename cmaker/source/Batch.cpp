@@ -0,0 +1,68 @@
+#include "Batch.hpp"
+
+#include "Trace.hpp"
+
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+liberror::Result<Configuration> parse_entry(nlohmann::json const& json)
+{
+    try
+    {
+        return json.get<Configuration>();
+    }
+    catch (std::exception const& exception)
+    {
+        return liberror::make_error(exception.what());
+    }
+}
+
+}
+
+liberror::Result<std::vector<liberror::Result<Configuration>>> load_batch(std::filesystem::path const& path)
+{
+    TraceSpan span("load batch");
+
+    std::ifstream stream(path);
+    if (!stream)
+    {
+        return liberror::make_error("Couldn't open \"{}\".", path.string());
+    }
+
+    std::stringstream content {};
+    content << stream.rdbuf();
+    auto const manifest = content.str();
+
+    std::vector<liberror::Result<Configuration>> configurations {};
+
+    auto const start = manifest.find_first_not_of(" \t\r\n");
+    if (start != std::string::npos && manifest[start] == '[')
+    {
+        try
+        {
+            auto const json = nlohmann::json::parse(manifest);
+            if (!json.is_array()) throw std::runtime_error("the manifest is not an array");
+            for (auto const& entry : json) configurations.push_back(parse_entry(entry));
+        }
+        catch (std::exception const& exception)
+        {
+            return liberror::make_error("Couldn't parse \"{}\": {}", path.string(), exception.what());
+        }
+
+        return configurations;
+    }
+
+    std::istringstream lines(manifest);
+    for (std::string line {}; std::getline(lines, line);)
+    {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        auto const json = nlohmann::json::parse(line, nullptr, false);
+        if (json.is_discarded()) configurations.push_back(liberror::make_error("Not a JSON object: {}", line));
+        else configurations.push_back(parse_entry(json));
+    }
+
+    return configurations;
+}
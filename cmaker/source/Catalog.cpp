@@ -0,0 +1,94 @@
+#include "Catalog.hpp"
+
+#include <liberror/Try.hpp>
+
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+std::string make_key(std::string_view language, std::string_view type = {}, std::string_view kind = {})
+{
+    std::string key {};
+    key.reserve(language.size() + type.size() + kind.size() + 2);
+    key.append(language).push_back('\0');
+    key.append(type).push_back('\0');
+    key.append(kind);
+    return key;
+}
+
+}
+
+liberror::Result<Catalog> Catalog::make(std::vector<Language> languages)
+{
+    Catalog catalog {};
+    catalog.m_languages = std::move(languages);
+
+    for (auto const& language : catalog.m_languages)
+    {
+        catalog.m_languageIndex.try_emplace(make_key(language.name), &language);
+
+        for (auto const& projectTemplate : language.templates)
+        {
+            catalog.m_templateIndex.try_emplace(make_key(language.name, projectTemplate.name), &projectTemplate);
+            catalog.m_graphIndex.try_emplace(make_key(language.name, projectTemplate.name), TRY(KindGraph::build(projectTemplate)));
+
+            for (auto const& kind : projectTemplate.kinds)
+            {
+                catalog.m_kindIndex.try_emplace(make_key(language.name, projectTemplate.name, kind.name), &kind);
+            }
+        }
+    }
+
+    return catalog;
+}
+
+Language const* Catalog::find_language(std::string_view language) const
+{
+    auto const found = m_languageIndex.find(make_key(language));
+    return found != m_languageIndex.end() ? found->second : nullptr;
+}
+
+Template const* Catalog::find_template(std::string_view language, std::string_view type) const
+{
+    auto const found = m_templateIndex.find(make_key(language, type));
+    return found != m_templateIndex.end() ? found->second : nullptr;
+}
+
+Kind const* Catalog::find_kind(std::string_view language, std::string_view type, std::string_view kind) const
+{
+    auto const found = m_kindIndex.find(make_key(language, type, kind));
+    return found != m_kindIndex.end() ? found->second : nullptr;
+}
+
+KindGraph const* Catalog::find_graph(std::string_view language, std::string_view type) const
+{
+    auto const found = m_graphIndex.find(make_key(language, type));
+    return found != m_graphIndex.end() ? &found->second : nullptr;
+}
+
+liberror::Result<Catalog> parse_catalog(std::string_view content, std::string_view origin)
+{
+    try
+    {
+        std::vector<Language> languages {};
+        nlohmann::json::parse(content).at("languages").get_to(languages);
+        return Catalog::make(std::move(languages));
+    }
+    catch (std::exception const& exception)
+    {
+        return liberror::make_error("Couldn't parse \"{}\": {}", origin, exception.what());
+    }
+}
+
+liberror::Result<Catalog> load_catalog(std::filesystem::path const& path)
+{
+    std::ifstream stream(path);
+    if (!stream)
+    {
+        return liberror::make_error("Couldn't open \"{}\".", path.string());
+    }
+
+    std::string const content(std::istreambuf_iterator<char>(stream), {});
+    return parse_catalog(content, path.string());
+}
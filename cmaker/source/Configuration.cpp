@@ -0,0 +1,61 @@
+#include "Configuration.hpp"
+
+#include "Trace.hpp"
+
+#include <liberror/Try.hpp>
+
+#include <algorithm>
+
+liberror::Result<void> sanitize_configuration(Configuration const& configuration, Catalog const& catalog)
+{
+    auto maybeLanguage = catalog.find_language(configuration.language);
+    if (maybeLanguage == nullptr)
+    {
+        return liberror::make_error("Language {} is not available.", configuration.language);
+    }
+
+    auto maybeStandard = std::ranges::find_if(maybeLanguage->standards, [&] (int standard) {
+        return std::to_string(standard) == configuration.standard;
+    });
+    if (maybeStandard == maybeLanguage->standards.end())
+    {
+        return liberror::make_error("Standard {} is not available for {}.", configuration.standard, configuration.language);
+    }
+
+    auto maybeTemplate = catalog.find_template(maybeLanguage->name, configuration.type);
+    if (maybeTemplate == nullptr)
+    {
+        return liberror::make_error("Template \"{}\" could not be found.", configuration.type);
+    }
+
+    auto maybeTemplateKind = catalog.find_kind(maybeLanguage->name, maybeTemplate->name, configuration.kind);
+    if (maybeTemplateKind == nullptr)
+    {
+        return liberror::make_error("Kind \"{}\" is not avaiable for template \"{}\"", configuration.kind, configuration.type);
+    }
+
+    auto const& graph = *catalog.find_graph(maybeLanguage->name, maybeTemplate->name);
+    auto const kindIndex = *graph.find_kind(maybeTemplateKind->name);
+
+    auto maybeFeature = std::ranges::find_if(configuration.features, [&] (std::string const& featureName) {
+        return !graph.is_available(kindIndex, featureName);
+    });
+    if (maybeFeature != configuration.features.end())
+    {
+        return liberror::make_error("Feature \"{}\" is not available for template of kind \"{}\"", *maybeFeature, configuration.kind);
+    }
+
+    return {};
+}
+
+liberror::Result<Configuration> configure_project(Configuration configuration, Catalog const& catalog)
+{
+    TraceSpan span("configure");
+
+    TRY(sanitize_configuration(configuration, catalog));
+
+    auto const& graph = *catalog.find_graph(configuration.language, configuration.type);
+    configuration.features = graph.resolve_features(*graph.find_kind(configuration.kind), configuration.features);
+
+    return configuration;
+}
@@ -0,0 +1,382 @@
+#include "Directives.hpp"
+
+#include <algorithm>
+
+namespace {
+
+enum class Type
+{
+    VALUE,
+    BOOLEAN
+};
+
+class ExpressionParser
+{
+public:
+    ExpressionParser(std::string_view content, std::size_t position, std::size_t end)
+        : m_content(content)
+        , m_position(position)
+        , m_end(end)
+    {}
+
+    std::size_t position() const { return m_position; }
+
+    void skip_spaces()
+    {
+        while (m_position < m_end && (m_content[m_position] == ' ' || m_content[m_position] == '\t')) m_position += 1;
+    }
+
+    bool consume(std::string_view token)
+    {
+        if (m_content.substr(m_position, std::min(token.size(), m_end - m_position)) != token) return false;
+        m_position += token.size();
+        return true;
+    }
+
+    // [<|NAME|>], [<literal>], [NOT [...]] or [operand OPERATOR operand], where an operand is a
+    // variable, a literal or another bracketed expression.
+    std::optional<Type> bracket(std::vector<Instruction>& nodes)
+    {
+        if (!consume("[")) return std::nullopt;
+        skip_spaces();
+
+        std::optional<Type> type {};
+
+        if (consume("NOT ") || (m_content.substr(m_position, 4) == "NOT[" && consume("NOT")))
+        {
+            skip_spaces();
+            if (operand(nodes) != Type::BOOLEAN) return std::nullopt;
+            nodes.push_back({ Instruction::NOT, 0, 0 });
+            type = Type::BOOLEAN;
+        }
+        else
+        {
+            auto const left = operand(nodes);
+            if (!left.has_value()) return std::nullopt;
+            skip_spaces();
+
+            if (m_position < m_end && m_content[m_position] == ']')
+            {
+                type = left;
+            }
+            else
+            {
+                auto const start = m_position;
+                while (m_position < m_end && m_content[m_position] >= 'A' && m_content[m_position] <= 'Z') m_position += 1;
+                auto const word = m_content.substr(start, m_position - start);
+                skip_spaces();
+
+                auto const right = operand(nodes);
+                if (!right.has_value() || *right != *left) return std::nullopt;
+
+                if (word == "EQUALS" && *left == Type::VALUE) nodes.push_back({ Instruction::EQUALS, 0, 0 });
+                else if (word == "CONTAINS" && *left == Type::VALUE) nodes.push_back({ Instruction::CONTAINS, 0, 0 });
+                else if (word == "AND" && *left == Type::BOOLEAN) nodes.push_back({ Instruction::AND, 0, 0 });
+                else if (word == "OR" && *left == Type::BOOLEAN) nodes.push_back({ Instruction::OR, 0, 0 });
+                else return std::nullopt;
+
+                type = Type::BOOLEAN;
+            }
+        }
+
+        skip_spaces();
+        if (!consume("]")) return std::nullopt;
+
+        return type;
+    }
+
+private:
+    std::optional<Type> operand(std::vector<Instruction>& nodes)
+    {
+        if (m_position < m_end && m_content[m_position] == '[') return bracket(nodes);
+
+        if (consume("<|"))
+        {
+            auto const close = m_content.substr(0, m_end).find("|>", m_position);
+            if (close == std::string_view::npos) return std::nullopt;
+            nodes.push_back({ Instruction::VARIABLE, static_cast<std::uint32_t>(m_position), static_cast<std::uint32_t>(close - m_position) });
+            m_position = close + 2;
+            return Type::VALUE;
+        }
+
+        if (consume("<"))
+        {
+            auto const close = m_content.substr(0, m_end).find('>', m_position);
+            if (close == std::string_view::npos) return std::nullopt;
+            nodes.push_back({ Instruction::LITERAL, static_cast<std::uint32_t>(m_position), static_cast<std::uint32_t>(close - m_position) });
+            m_position = close + 1;
+            return Type::VALUE;
+        }
+
+        return std::nullopt;
+    }
+
+    std::string_view m_content;
+    std::size_t m_position;
+    std::size_t m_end;
+};
+
+struct Block
+{
+    enum Kind
+    {
+        IF,
+        ELSE,
+        SWITCH,
+        CASE,
+        DEFAULT
+    };
+
+    Kind kind;
+    std::size_t patch;
+    std::vector<Instruction> value {};
+    std::vector<std::size_t> exits {};
+    bool hasDefault { false };
+};
+
+}
+
+std::optional<std::vector<Instruction>> compile_directives(std::string_view content)
+{
+    // Offsets are stored as 32 bits, which is plenty for a template.
+    if (content.size() > UINT32_MAX) return std::nullopt;
+
+    std::vector<Instruction> program {};
+    std::vector<Block> blocks {};
+
+    // Consecutive text lines become one span. Only directive lines separate them, so no jump can
+    // land in between.
+    auto fnText = [&] (std::size_t start, std::size_t end) {
+        if (!program.empty() && program.back().operation == Instruction::TEXT && program.back().first + program.back().second == start)
+        {
+            program.back().second += static_cast<std::uint32_t>(end - start);
+            return;
+        }
+
+        program.push_back({ Instruction::TEXT, static_cast<std::uint32_t>(start), static_cast<std::uint32_t>(end - start) });
+    };
+
+    auto fnHere = [&] { return static_cast<std::uint32_t>(program.size()); };
+
+    auto fnBranch = [&] (std::vector<Instruction> const& nodes) {
+        auto const branch = program.size();
+        program.push_back({ Instruction::BRANCH, 0, static_cast<std::uint32_t>(nodes.size()) });
+        program.insert(program.end(), nodes.begin(), nodes.end());
+        return branch;
+    };
+
+    for (std::size_t lineStart = 0; lineStart < content.size();)
+    {
+        auto lineEnd = content.find('\n', lineStart);
+        auto const next = lineEnd == std::string_view::npos ? content.size() : lineEnd + 1;
+        if (lineEnd == std::string_view::npos) lineEnd = content.size();
+
+        auto const indentation = content.find_first_not_of(" \t", lineStart);
+        auto const isDirective = indentation != std::string_view::npos && indentation < lineEnd && content[indentation] == '%';
+
+        if (!isDirective)
+        {
+            // Text can't sit between the cases of a switch.
+            if (!blocks.empty() && blocks.back().kind == Block::SWITCH) return std::nullopt;
+
+            // `@@ text` drops the indentation in front of it, one level of four spaces per `@`.
+            auto textStart = lineStart;
+            if (indentation != std::string_view::npos && indentation < lineEnd && content[indentation] == '@')
+            {
+                auto const markers = content.find_first_not_of('@', indentation);
+                if (markers >= lineEnd || content[markers] != ' ') return std::nullopt;
+                if (content.substr(lineStart, indentation - lineStart) != std::string(4 * (markers - indentation), ' ')) return std::nullopt;
+                textStart = markers + 1;
+            }
+
+            fnText(textStart, next);
+            lineStart = next;
+            continue;
+        }
+
+        auto directiveEnd = lineEnd;
+        while (directiveEnd > indentation && (content[directiveEnd - 1] == ' ' || content[directiveEnd - 1] == '\t' || content[directiveEnd - 1] == '\r')) directiveEnd -= 1;
+
+        ExpressionParser parser(content, indentation + 1, directiveEnd);
+        std::vector<Instruction> nodes {};
+
+        auto fnCondition = [&] () -> std::optional<Type> {
+            parser.skip_spaces();
+            auto const type = parser.bracket(nodes);
+            if (!type.has_value() || !parser.consume(":") || parser.position() != directiveEnd) return std::nullopt;
+            return type;
+        };
+
+        auto fnBare = [&] (std::string_view rest) {
+            return parser.consume(rest) && parser.position() == directiveEnd;
+        };
+
+        if (parser.consume("IF "))
+        {
+            if (fnCondition() != Type::BOOLEAN) return std::nullopt;
+            blocks.push_back({ .kind = Block::IF, .patch = fnBranch(nodes) });
+        }
+        else if (parser.consume("SWITCH "))
+        {
+            if (fnCondition() != Type::VALUE) return std::nullopt;
+            blocks.push_back({ .kind = Block::SWITCH, .patch = 0, .value = std::move(nodes) });
+        }
+        else if (parser.consume("CASE "))
+        {
+            if (blocks.empty() || blocks.back().kind != Block::SWITCH || blocks.back().hasDefault) return std::nullopt;
+            if (fnCondition() != Type::VALUE) return std::nullopt;
+
+            auto condition = blocks.back().value;
+            condition.insert(condition.end(), nodes.begin(), nodes.end());
+            condition.push_back({ Instruction::EQUALS, 0, 0 });
+            blocks.push_back({ .kind = Block::CASE, .patch = fnBranch(condition) });
+        }
+        else if (fnBare("DEFAULT:"))
+        {
+            if (blocks.empty() || blocks.back().kind != Block::SWITCH || blocks.back().hasDefault) return std::nullopt;
+            blocks.back().hasDefault = true;
+            blocks.push_back({ .kind = Block::DEFAULT, .patch = 0 });
+        }
+        else if (fnBare("ELSE:"))
+        {
+            if (blocks.empty() || blocks.back().kind != Block::IF) return std::nullopt;
+            auto const jump = program.size();
+            program.push_back({ Instruction::JUMP, 0, 0 });
+            program[blocks.back().patch].first = fnHere();
+            blocks.back() = { .kind = Block::ELSE, .patch = jump };
+        }
+        else if (fnBare("END"))
+        {
+            if (blocks.empty()) return std::nullopt;
+
+            auto block = std::move(blocks.back());
+            blocks.pop_back();
+
+            switch (block.kind)
+            {
+            case Block::IF:
+            case Block::ELSE:
+                program[block.patch].first = fnHere();
+                break;
+            case Block::CASE:
+                blocks.back().exits.push_back(program.size());
+                program.push_back({ Instruction::JUMP, 0, 0 });
+                program[block.patch].first = fnHere();
+                break;
+            case Block::DEFAULT:
+                break;
+            case Block::SWITCH:
+                for (auto const exit : block.exits) program[exit].first = fnHere();
+                break;
+            }
+        }
+        else
+        {
+            return std::nullopt;
+        }
+
+        lineStart = next;
+    }
+
+    if (!blocks.empty()) return std::nullopt;
+
+    return program;
+}
+
+liberror::Result<std::string> run_directives(std::span<Instruction const> program, std::string_view content, std::unordered_map<std::string, std::string> const& variables)
+{
+    struct Value
+    {
+        std::string_view text;
+        bool truth;
+    };
+
+    auto fnSpan = [&] (Instruction const& instruction) {
+        return content.substr(instruction.first, instruction.second);
+    };
+
+    auto fnVariable = [&] (std::string_view name) -> std::optional<std::string_view> {
+        for (auto const& [variable, value] : variables)
+        {
+            if (variable == name) return value;
+        }
+        return std::nullopt;
+    };
+
+    // Directives only ever remove lines, so the output can't outgrow the template.
+    std::string output {};
+    output.reserve(content.size());
+
+    std::vector<Value> stack {};
+
+    for (std::size_t index = 0; index < program.size();)
+    {
+        auto const& instruction = program[index];
+
+        if (instruction.operation == Instruction::TEXT)
+        {
+            output.append(fnSpan(instruction));
+            index += 1;
+            continue;
+        }
+
+        if (instruction.operation == Instruction::JUMP)
+        {
+            index = instruction.first;
+            continue;
+        }
+
+        if (instruction.operation != Instruction::BRANCH || index + 1 + instruction.second > program.size())
+        {
+            return liberror::make_error("Compiled template is corrupted.");
+        }
+
+        stack.clear();
+        for (auto const& node : program.subspan(index + 1, instruction.second))
+        {
+            if (node.operation == Instruction::LITERAL)
+            {
+                stack.push_back({ fnSpan(node), false });
+                continue;
+            }
+
+            if (node.operation == Instruction::VARIABLE)
+            {
+                auto const value = fnVariable(fnSpan(node));
+                if (!value.has_value()) return liberror::make_error("Variable \"{}\" is not defined.", fnSpan(node));
+                stack.push_back({ *value, false });
+                continue;
+            }
+
+            if (stack.empty() || (node.operation != Instruction::NOT && stack.size() < 2))
+            {
+                return liberror::make_error("Compiled template is corrupted.");
+            }
+
+            if (node.operation == Instruction::NOT)
+            {
+                stack.back().truth = !stack.back().truth;
+                continue;
+            }
+
+            auto const right = stack.back();
+            stack.pop_back();
+            auto& left = stack.back();
+
+            switch (node.operation)
+            {
+            case Instruction::EQUALS: left.truth = left.text == right.text; break;
+            case Instruction::CONTAINS: left.truth = left.text.contains(right.text); break;
+            case Instruction::AND: left.truth = left.truth && right.truth; break;
+            case Instruction::OR: left.truth = left.truth || right.truth; break;
+            default: return liberror::make_error("Compiled template is corrupted.");
+            }
+        }
+
+        if (stack.size() != 1) return liberror::make_error("Compiled template is corrupted.");
+
+        index = stack.back().truth ? index + 1 + instruction.second : instruction.first;
+    }
+
+    return output;
+}
@@ -0,0 +1,515 @@
+#include "FileWriter.hpp"
+
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <linux/io_uring.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr unsigned QUEUE_DEPTH = 256;
+// Each file in flight holds one registered descriptor and up to three submission entries.
+constexpr unsigned SLOTS = QUEUE_DEPTH / 4;
+// Larger contents are written with several requests.
+constexpr std::size_t MAX_WRITE = std::size_t { 1 } << 30;
+
+enum Operation : std::uint64_t
+{
+    OPEN,
+    WRITE,
+    CLOSE
+};
+
+liberror::Result<void> write_error(std::filesystem::path const& path, int error)
+{
+    return liberror::make_error("Couldn't write to \"{}\": {}.", path.string(), std::strerror(error));
+}
+
+mode_t mode_of(std::filesystem::perms permissions)
+{
+    return static_cast<mode_t>(permissions & std::filesystem::perms::mask);
+}
+
+int write_all(int descriptor, std::string_view content)
+{
+    while (!content.empty())
+    {
+        auto const written = ::write(descriptor, content.data(), content.size());
+        if (written == -1 && errno == EINTR) continue;
+        if (written == -1) return errno;
+        if (written == 0) return EIO;
+        content.remove_prefix(static_cast<std::size_t>(written));
+    }
+
+    return 0;
+}
+
+// Copies the template file without it ever passing through user space: as a reflink where the
+// filesystem supports it, otherwise with copy_file_range. Returns how much was copied, the rest is
+// written from `content`, e.g. when the template went missing since the pack was built.
+std::size_t clone_file(FileWrite const& file, int output)
+{
+    auto const input = ::open(file.source.c_str(), O_RDONLY | O_CLOEXEC);
+    if (input == -1) return 0;
+
+    std::size_t copied = 0;
+
+    if (::ioctl(output, FICLONE, input) == 0)
+    {
+        copied = file.content.size();
+    }
+    else
+    {
+        while (copied < file.content.size())
+        {
+            auto const result = ::copy_file_range(input, nullptr, output, nullptr, file.content.size() - copied, 0);
+            if (result == -1 && errno == EINTR) continue;
+            if (result <= 0) break;
+            copied += static_cast<std::size_t>(result);
+        }
+    }
+
+    ::close(input);
+
+    return copied;
+}
+
+// Writes whatever `written` leaves of the content, then sets the permissions and closes the file.
+int finish_file(FileWrite const& file, int output, std::size_t written)
+{
+    auto error = write_all(output, file.content.substr(written));
+    if (::fchmod(output, mode_of(file.permissions)) != 0 && error == 0) error = errno;
+    if (::close(output) != 0 && error == 0) error = errno;
+
+    return error;
+}
+
+liberror::Result<void> write_file(FileWrite const& file)
+{
+    TraceSpan span(file.source.empty() ? "write" : "copy", file.destination.native());
+    span.set_bytes(file.content.size());
+
+    auto const output = ::open(file.destination.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (output == -1) return write_error(file.destination, errno);
+
+    auto const copied = file.source.empty() ? 0 : clone_file(file, output);
+
+    if (auto const error = finish_file(file, output, copied); error != 0) return write_error(file.destination, error);
+
+    return {};
+}
+
+// Creates the file from its template file for the io_uring backend, which has no request to clone
+// with. Returns false when not a byte could be cloned, leaving no file behind for the ring to write.
+bool clone_new_file(FileWrite const& file, int& error)
+{
+    TraceSpan span("copy", file.destination.native());
+    span.set_bytes(file.content.size());
+
+    auto const output = ::open(file.destination.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (output == -1)
+    {
+        error = errno;
+        return true;
+    }
+
+    auto const copied = clone_file(file, output);
+    if (copied == 0)
+    {
+        ::close(output);
+        ::unlink(file.destination.c_str());
+        return false;
+    }
+
+    error = finish_file(file, output, copied);
+
+    return true;
+}
+
+}
+
+struct FileWriter::Ring
+{
+    int descriptor { -1 };
+    void* submissionRing { MAP_FAILED };
+    std::size_t submissionRingSize { 0 };
+    void* completionRing { MAP_FAILED };
+    std::size_t completionRingSize { 0 };
+    io_uring_sqe* entries { static_cast<io_uring_sqe*>(MAP_FAILED) };
+    std::size_t entriesSize { 0 };
+
+    unsigned* submissionHead { nullptr };
+    unsigned* submissionTail { nullptr };
+    unsigned* submissionArray { nullptr };
+    unsigned submissionMask { 0 };
+    unsigned submissionEntries { 0 };
+
+    unsigned* completionHead { nullptr };
+    unsigned* completionTail { nullptr };
+    io_uring_cqe* completions { nullptr };
+    unsigned completionMask { 0 };
+
+    unsigned tail { 0 };
+    unsigned pending { 0 };
+    mode_t umask { 0 };
+
+    Ring() = default;
+    Ring(Ring const&) = delete;
+    Ring& operator=(Ring const&) = delete;
+
+    ~Ring()
+    {
+        if (entries != MAP_FAILED) ::munmap(entries, entriesSize);
+        if (completionRing != MAP_FAILED && completionRing != submissionRing) ::munmap(completionRing, completionRingSize);
+        if (submissionRing != MAP_FAILED) ::munmap(submissionRing, submissionRingSize);
+        if (descriptor != -1) ::close(descriptor);
+    }
+
+    static std::unique_ptr<Ring> make();
+
+    unsigned space() const
+    {
+        return submissionEntries - (tail - std::atomic_ref(*submissionHead).load(std::memory_order_acquire));
+    }
+
+    io_uring_sqe* next_entry()
+    {
+        auto const index = tail & submissionMask;
+        auto* entry = &entries[index];
+
+        std::memset(entry, 0, sizeof(*entry));
+        submissionArray[index] = index;
+        tail += 1;
+        pending += 1;
+
+        return entry;
+    }
+
+    // Submits everything queued and waits for at least `wait` completions, returning 0 or an errno.
+    int enter(unsigned wait)
+    {
+        std::atomic_ref(*submissionTail).store(tail, std::memory_order_release);
+
+        while (true)
+        {
+            auto const result = ::syscall(__NR_io_uring_enter, descriptor, pending, wait, wait != 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+
+            if (result == -1 && errno == EINTR) continue;
+            if (result == -1) return errno;
+
+            pending -= static_cast<unsigned>(result);
+            if (pending == 0) return 0;
+        }
+    }
+
+    template <class Fn>
+    void reap(Fn&& fn)
+    {
+        auto head = *completionHead;
+        auto const last = std::atomic_ref(*completionTail).load(std::memory_order_acquire);
+
+        for (; head != last; head += 1)
+        {
+            auto const& completion = completions[head & completionMask];
+            fn(completion.user_data, completion.res);
+        }
+
+        std::atomic_ref(*completionHead).store(head, std::memory_order_release);
+    }
+};
+
+std::unique_ptr<FileWriter::Ring> FileWriter::Ring::make()
+{
+    auto ring = std::make_unique<Ring>();
+
+    io_uring_params params {};
+    ring->descriptor = static_cast<int>(::syscall(__NR_io_uring_setup, QUEUE_DEPTH, &params));
+    if (ring->descriptor == -1) return nullptr;
+
+    ring->submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    ring->entriesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+    auto const isSingleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (isSingleMap) ring->submissionRingSize = std::max(ring->submissionRingSize, ring->completionRingSize);
+
+    ring->submissionRing = ::mmap(nullptr, ring->submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->descriptor, IORING_OFF_SQ_RING);
+    if (ring->submissionRing == MAP_FAILED) return nullptr;
+
+    ring->completionRing = isSingleMap
+        ? ring->submissionRing
+        : ::mmap(nullptr, ring->completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->descriptor, IORING_OFF_CQ_RING);
+    if (ring->completionRing == MAP_FAILED) return nullptr;
+
+    ring->entries = static_cast<io_uring_sqe*>(::mmap(nullptr, ring->entriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->descriptor, IORING_OFF_SQES));
+    if (ring->entries == MAP_FAILED) return nullptr;
+
+    auto* submission = static_cast<char*>(ring->submissionRing);
+    ring->submissionHead = reinterpret_cast<unsigned*>(submission + params.sq_off.head);
+    ring->submissionTail = reinterpret_cast<unsigned*>(submission + params.sq_off.tail);
+    ring->submissionArray = reinterpret_cast<unsigned*>(submission + params.sq_off.array);
+    ring->submissionMask = *reinterpret_cast<unsigned*>(submission + params.sq_off.ring_mask);
+    ring->submissionEntries = params.sq_entries;
+    ring->tail = *ring->submissionTail;
+
+    auto* completion = static_cast<char*>(ring->completionRing);
+    ring->completionHead = reinterpret_cast<unsigned*>(completion + params.cq_off.head);
+    ring->completionTail = reinterpret_cast<unsigned*>(completion + params.cq_off.tail);
+    ring->completions = reinterpret_cast<io_uring_cqe*>(completion + params.cq_off.cqes);
+    ring->completionMask = *reinterpret_cast<unsigned*>(completion + params.cq_off.ring_mask);
+
+    std::vector<int> slots(SLOTS, -1);
+    if (::syscall(__NR_io_uring_register, ring->descriptor, IORING_REGISTER_FILES, slots.data(), SLOTS) != 0) return nullptr;
+
+    // Opening into a registered slot and closing it again is what every file does, and it is the
+    // part older kernels reject, so it is tried once here rather than failing a whole batch later.
+    auto* open = ring->next_entry();
+    open->opcode = IORING_OP_OPENAT;
+    open->flags = IOSQE_IO_LINK;
+    open->fd = AT_FDCWD;
+    open->addr = reinterpret_cast<std::uint64_t>(".");
+    open->open_flags = O_RDONLY | O_DIRECTORY;
+    open->file_index = 1;
+
+    auto* close = ring->next_entry();
+    close->opcode = IORING_OP_CLOSE;
+    close->file_index = 1;
+
+    if (ring->enter(2) != 0) return nullptr;
+
+    auto isSupported = true;
+    auto completed = 0;
+    while (completed < 2)
+    {
+        ring->reap([&] (std::uint64_t, int result) {
+            completed += 1;
+            if (result != 0) isSupported = false;
+        });
+
+        if (completed < 2 && ring->enter(1) != 0) return nullptr;
+    }
+
+    if (!isSupported) return nullptr;
+
+    // Reading the umask means setting it, which is only safe before any file is being written.
+    ring->umask = ::umask(0);
+    ::umask(ring->umask);
+
+    return ring;
+}
+
+FileWriter FileWriter::make(IoBackend backend)
+{
+    FileWriter writer {};
+    if (backend == IoBackend::URING) writer.m_ring = Ring::make();
+    return writer;
+}
+
+FileWriter::FileWriter(FileWriter&& other) noexcept = default;
+FileWriter& FileWriter::operator=(FileWriter&& other) noexcept = default;
+FileWriter::~FileWriter() = default;
+
+liberror::Result<void> FileWriter::write(std::span<FileWrite const> files, ThreadPool& pool)
+{
+    TraceSpan span(m_ring != nullptr ? "write files (io_uring)" : "write files");
+
+    std::uint64_t bytes = 0;
+    for (auto const& file : files) bytes += file.content.size();
+    span.set_bytes(bytes);
+
+    if (m_ring != nullptr) return write_uring(files, pool);
+    return write_blocking(files, pool);
+}
+
+liberror::Result<void> FileWriter::write_blocking(std::span<FileWrite const> files, ThreadPool& pool)
+{
+    std::vector<liberror::Result<void>> results(files.size());
+    pool.for_each(files.size(), [&] (std::size_t index) {
+        results[index] = write_file(files[index]);
+    });
+
+    for (auto const& result : results)
+    {
+        if (!result.has_value()) return result;
+    }
+
+    return {};
+}
+
+liberror::Result<void> FileWriter::write_uring(std::span<FileWrite const> files, ThreadPool& pool)
+{
+    auto& ring = *m_ring;
+
+    struct State
+    {
+        unsigned slot;
+        unsigned outstanding;
+        std::size_t written;
+        int error;
+        bool isOpen;
+        bool isClosed;
+        bool isCloned;
+    };
+
+    std::vector<State> states(files.size());
+
+    // Template files are cloned from the pool's workers first, only the rest goes through the ring.
+    std::vector<std::size_t> cloned {};
+    for (std::size_t index = 0; index < files.size(); index += 1)
+    {
+        if (!files[index].source.empty() && !files[index].content.empty()) cloned.push_back(index);
+    }
+
+    pool.for_each(cloned.size(), [&] (std::size_t position) {
+        auto const index = cloned[position];
+        states[index].isCloned = clone_new_file(files[index], states[index].error);
+    });
+
+    std::vector<std::size_t> queued {};
+    for (std::size_t index = 0; index < files.size(); index += 1)
+    {
+        if (!states[index].isCloned) queued.push_back(index);
+    }
+
+    std::vector<unsigned> slots {};
+    for (auto slot = SLOTS; slot > 0; slot -= 1) slots.push_back(slot - 1);
+
+    auto fnData = [] (std::size_t index, Operation operation) {
+        return (static_cast<std::uint64_t>(index) << 2) | operation;
+    };
+
+    auto fnQueueClose = [&] (std::size_t index) {
+        auto* close = ring.next_entry();
+        close->opcode = IORING_OP_CLOSE;
+        close->file_index = states[index].slot + 1;
+        close->user_data = fnData(index, CLOSE);
+        states[index].outstanding += 1;
+    };
+
+    // The last write is linked to the close, so a failed or short write cancels it and the file
+    // comes back here with its descriptor still open.
+    auto fnQueueWrites = [&] (std::size_t index) {
+        auto& state = states[index];
+        auto const remaining = files[index].content.size() - state.written;
+        auto const size = std::min(remaining, MAX_WRITE);
+        auto const isLast = size == remaining;
+
+        if (size != 0)
+        {
+            auto* write = ring.next_entry();
+            write->opcode = IORING_OP_WRITE;
+            write->flags = static_cast<std::uint8_t>(IOSQE_FIXED_FILE | (isLast ? IOSQE_IO_LINK : 0));
+            write->fd = static_cast<std::int32_t>(state.slot);
+            write->addr = reinterpret_cast<std::uint64_t>(files[index].content.data() + state.written);
+            write->len = static_cast<std::uint32_t>(size);
+            write->off = state.written;
+            write->user_data = fnData(index, WRITE);
+            state.outstanding += 1;
+        }
+
+        if (isLast) fnQueueClose(index);
+    };
+
+    auto fnQueueOpen = [&] (std::size_t index) {
+        auto& state = states[index];
+        state.slot = slots.back();
+        slots.pop_back();
+
+        // Opened with its final permissions, the umask is dealt with once everything is written.
+        auto* open = ring.next_entry();
+        open->opcode = IORING_OP_OPENAT;
+        open->flags = IOSQE_IO_LINK;
+        open->fd = AT_FDCWD;
+        open->addr = reinterpret_cast<std::uint64_t>(files[index].destination.c_str());
+        open->len = mode_of(files[index].permissions);
+        open->open_flags = O_WRONLY | O_CREAT | O_EXCL;
+        open->file_index = state.slot + 1;
+        open->user_data = fnData(index, OPEN);
+        state.outstanding = 1;
+
+        fnQueueWrites(index);
+    };
+
+    std::size_t next = 0;
+    std::size_t finished = 0;
+
+    auto fnComplete = [&] (std::uint64_t data, int result) {
+        auto const index = static_cast<std::size_t>(data >> 2);
+        auto& state = states[index];
+        state.outstanding -= 1;
+
+        switch (data & 3)
+        {
+        case OPEN:
+            if (result < 0) state.error = -result;
+            else state.isOpen = true;
+            break;
+        case WRITE:
+            if (result > 0) state.written += static_cast<std::size_t>(result);
+            else if (result == 0 && state.error == 0) state.error = EIO;
+            else if (result != -ECANCELED && state.error == 0) state.error = -result;
+            break;
+        case CLOSE:
+            if (result == -ECANCELED) break;
+            state.isClosed = true;
+            if (result < 0 && state.error == 0) state.error = -result;
+            break;
+        }
+
+        if (state.outstanding != 0) return;
+
+        if (state.isOpen && !state.isClosed)
+        {
+            if (state.error != 0) fnQueueClose(index);
+            else fnQueueWrites(index);
+            return;
+        }
+
+        slots.push_back(state.slot);
+        finished += 1;
+    };
+
+    while (finished < queued.size())
+    {
+        while (next < queued.size() && !slots.empty() && ring.space() >= 3) fnQueueOpen(queued[next++]);
+
+        if (auto const error = ring.enter(1); error != 0)
+        {
+            // Whatever was in flight is lost track of, so later batches go through the blocking
+            // backend instead.
+            m_ring.reset();
+            return liberror::make_error("Couldn't submit writes to io_uring: {}.", std::strerror(error));
+        }
+
+        ring.reap(fnComplete);
+    }
+
+    for (std::size_t index = 0; index < files.size(); index += 1)
+    {
+        auto const& file = files[index];
+        auto& state = states[index];
+        auto const mode = mode_of(file.permissions);
+
+        if (state.error == 0 && !state.isCloned && (mode & ~ring.umask) != mode && ::chmod(file.destination.c_str(), mode) != 0)
+        {
+            state.error = errno;
+        }
+
+        if (state.error != 0) return write_error(file.destination, state.error);
+    }
+
+    return {};
+}
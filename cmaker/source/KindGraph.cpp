@@ -0,0 +1,228 @@
+#include "KindGraph.hpp"
+
+#include "Catalog.hpp"
+
+#include <liberror/Try.hpp>
+
+#include <algorithm>
+
+namespace {
+
+enum class Mark
+{
+    NONE,
+    VISITING,
+    DONE
+};
+
+}
+
+liberror::Result<KindGraph> KindGraph::build(Template const& projectTemplate)
+{
+    KindGraph graph {};
+
+    for (auto const& kind : projectTemplate.kinds)
+    {
+        if (!graph.m_kindIndex.try_emplace(kind.name, graph.m_kinds.size()).second)
+        {
+            return liberror::make_error("Kind \"{}\" is declared more than once in template \"{}\".", kind.name, projectTemplate.name);
+        }
+        graph.m_kinds.push_back(&kind);
+    }
+
+    auto fnAddFeature = [&] (std::string_view name) {
+        if (graph.m_featureIndex.try_emplace(name, graph.m_features.size()).second) graph.m_features.push_back(name);
+    };
+
+    auto const kindCount = graph.m_kinds.size();
+    std::vector<std::vector<Index>> parents(kindCount);
+
+    for (Index index = 0; index < kindCount; index += 1)
+    {
+        auto const& kind = *graph.m_kinds[index];
+
+        if (kind.inherits.has_value())
+        {
+            for (auto const& parentName : *kind.inherits)
+            {
+                auto const parent = graph.find_kind(parentName);
+                if (!parent.has_value())
+                {
+                    return liberror::make_error("Kind \"{}\" of template \"{}\" inherits from \"{}\", which doesn't exist.", kind.name, projectTemplate.name, parentName);
+                }
+                parents[index].push_back(*parent);
+            }
+        }
+
+        if (kind.features.has_value())
+        {
+            for (auto const& feature : *kind.features)
+            {
+                fnAddFeature(feature.name);
+                if (!feature.requirez.has_value()) continue;
+                for (auto const& required : *feature.requirez) fnAddFeature(required);
+            }
+        }
+    }
+
+    std::vector<Mark> marks(kindCount, Mark::NONE);
+    std::vector<Index> order {};
+    std::vector<Index> path {};
+
+    auto fnVisit = [&] (this auto&& self, Index index) -> liberror::Result<void> {
+        if (marks[index] == Mark::DONE) return {};
+
+        if (marks[index] == Mark::VISITING)
+        {
+            std::string cycle {};
+            for (auto const step : std::ranges::subrange(std::ranges::find(path, index), path.end()))
+            {
+                cycle += graph.m_kinds[step]->name + " -> ";
+            }
+            cycle += graph.m_kinds[index]->name;
+            return liberror::make_error("Kinds of template \"{}\" inherit from each other: {}.", projectTemplate.name, cycle);
+        }
+
+        marks[index] = Mark::VISITING;
+        path.push_back(index);
+        for (auto const parent : parents[index]) TRY(self(parent));
+        path.pop_back();
+        marks[index] = Mark::DONE;
+        order.push_back(index);
+
+        return {};
+    };
+
+    for (Index index = 0; index < kindCount; index += 1)
+    {
+        TRY(fnVisit(index));
+    }
+
+    std::vector<IndexSet> ancestors(kindCount, IndexSet(kindCount));
+    graph.m_lineages.resize(kindCount);
+
+    for (auto const index : order)
+    {
+        for (auto const parent : parents[index])
+        {
+            ancestors[index] |= ancestors[parent];
+            ancestors[index].insert(parent);
+        }
+
+        std::ranges::copy_if(order, std::back_inserter(graph.m_lineages[index]), [&] (Index other) { return ancestors[index].contains(other); });
+        graph.m_lineages[index].push_back(index);
+    }
+
+    auto const featureCount = graph.m_features.size();
+    graph.m_available.assign(kindCount, IndexSet(featureCount));
+    graph.m_required.assign(kindCount, IndexSet(featureCount));
+    graph.m_requirements.assign(kindCount, std::vector<IndexSet>(featureCount, IndexSet(featureCount)));
+
+    for (Index index = 0; index < kindCount; index += 1)
+    {
+        auto& requirements = graph.m_requirements[index];
+
+        for (auto const member : graph.m_lineages[index])
+        {
+            if (!graph.m_kinds[member]->features.has_value()) continue;
+
+            for (auto const& feature : *graph.m_kinds[member]->features)
+            {
+                auto const featureIndex = graph.m_featureIndex.at(feature.name);
+                graph.m_available[index].insert(featureIndex);
+                if (!feature.requirez.has_value()) continue;
+                for (auto const& required : *feature.requirez) requirements[featureIndex].insert(graph.m_featureIndex.at(required));
+            }
+        }
+
+        std::vector<Mark> featureMarks(featureCount, Mark::NONE);
+
+        auto fnClose = [&] (this auto&& self, Index feature) -> liberror::Result<void> {
+            if (featureMarks[feature] == Mark::DONE) return {};
+
+            if (featureMarks[feature] == Mark::VISITING)
+            {
+                return liberror::make_error("Feature \"{}\" of kind \"{}\" ends up requiring itself.", graph.m_features[feature], graph.m_kinds[index]->name);
+            }
+
+            featureMarks[feature] = Mark::VISITING;
+            for (auto const required : requirements[feature].elements())
+            {
+                TRY(self(required));
+                requirements[feature] |= requirements[required];
+            }
+            featureMarks[feature] = Mark::DONE;
+
+            return {};
+        };
+
+        for (Index feature = 0; feature < featureCount; feature += 1)
+        {
+            TRY(fnClose(feature));
+        }
+
+        for (auto const member : graph.m_lineages[index])
+        {
+            if (!graph.m_kinds[member]->features.has_value()) continue;
+
+            for (auto const& feature : *graph.m_kinds[member]->features)
+            {
+                if (feature.optional) continue;
+                auto const featureIndex = graph.m_featureIndex.at(feature.name);
+                graph.m_required[index].insert(featureIndex);
+                graph.m_required[index] |= requirements[featureIndex];
+            }
+        }
+    }
+
+    return graph;
+}
+
+std::optional<KindGraph::Index> KindGraph::find_kind(std::string_view name) const
+{
+    auto const found = m_kindIndex.find(name);
+    if (found == m_kindIndex.end()) return std::nullopt;
+    return found->second;
+}
+
+std::optional<KindGraph::Index> KindGraph::find_feature(std::string_view name) const
+{
+    auto const found = m_featureIndex.find(name);
+    if (found == m_featureIndex.end()) return std::nullopt;
+    return found->second;
+}
+
+bool KindGraph::is_available(Index kind, std::string_view feature) const
+{
+    auto const featureIndex = find_feature(feature);
+    return featureIndex.has_value() && m_available[kind].contains(*featureIndex);
+}
+
+std::vector<std::string> KindGraph::resolve_features(Index kind, std::span<std::string const> requested) const
+{
+    std::vector<std::string> features {};
+    IndexSet present(m_features.size());
+
+    auto fnAppend = [&] (Index feature) {
+        if (present.contains(feature)) return;
+        present.insert(feature);
+        features.emplace_back(m_features[feature]);
+    };
+
+    for (auto const& name : requested)
+    {
+        auto const feature = find_feature(name);
+        if (!feature.has_value())
+        {
+            if (std::ranges::find(features, name) == features.end()) features.push_back(name);
+            continue;
+        }
+
+        m_requirements[kind][*feature].for_each(fnAppend);
+        fnAppend(*feature);
+    }
+
+    m_required[kind].for_each(fnAppend);
+
+    return features;
+}
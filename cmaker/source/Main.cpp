@@ -1,410 +1,299 @@
+#include "Archive.hpp"
+#include "Batch.hpp"
+#include "Catalog.hpp"
+#include "Configuration.hpp"
 #include "Environment.hpp"
+#include "Manifest.hpp"
+#include "Pack.hpp"
+#include "Plan.hpp"
+#include "Render.hpp"
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+#include "Update.hpp"
+#include "Watch.hpp"
 
 #include <argparse/argparse.hpp>
-#include <fplus/container_common.hpp>
-#include <fplus/fplus.hpp>
 #include <liberror/Result.hpp>
 #include <liberror/Try.hpp>
-#include <libpreprocessor/Processor.hpp>
-#include <nlohmann/json.hpp>
 
-#include <functional>
 #include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <iostream>
 #include <optional>
+#include <random>
 #include <span>
+#include <string>
+#include <string_view>
 #include <sstream>
+#include <thread>
 
-struct Feature
-{
-    std::string name;
-    bool optional;
-    std::optional<std::vector<std::string>> requirez;
+#include <fcntl.h>
+#include <unistd.h>
 
-    friend void to_json(nlohmann::json& json, Feature const& type)
-    {
-        json["name"] = type.name;
-        json["optional"] = type.optional;
-        if (type.requirez.has_value()) json["requires"] = *type.requirez;
-    }
+Configuration parse_configuration(argparse::ArgumentParser const& parser)
+{
+    return {
+        .name = parser.get<std::string>("--name"),
+        .language = parser.get<std::string>("--lang"),
+        .standard = [&] () {
+            std::stringstream stream {};
+            stream << parser.get<int>("--std");
+            return stream.str();
+        }(),
+        .type = parser.get<std::string>("type"),
+        .kind = parser.get<std::string>("--kind"),
+        .features = parser.get<std::vector<std::string>>("--features")
+    };
+}
 
-    friend void from_json(nlohmann::json const& json, Feature& type)
-    {
-        json.at("name").get_to(type.name);
-        json.at("optional").get_to(type.optional);
-        if (json.count("requires")) type.requirez = json.at("requires").get<std::vector<std::string>>();
-    }
-};
+IoBackend parse_io_backend(argparse::ArgumentParser const& parser)
+{
+    return parser.get<std::string>("--io") == "uring" ? IoBackend::URING : IoBackend::BLOCKING;
+}
 
-struct Kind
+Plan plan_project(Configuration const& configuration, Pack const& pack, RenderContext const& context)
 {
-    std::string name;
-    std::optional<std::vector<Feature>> features;
-    std::optional<std::vector<std::string>> inherits;
+    auto const& graph = *pack.catalog().find_graph(configuration.language, configuration.type);
+    return make_plan(pack, collect_layers(configuration, graph), context.wildcards);
+}
 
-    friend void to_json(nlohmann::json& json, Kind const& type)
+void print_plan(Plan const& plan)
+{
+    for (auto const& file : plan.files)
     {
-        json["name"] = type.name;
-        if (type.features.has_value()) json["features"] = *type.features;
-        if (type.inherits.has_value()) json["inherits"] = *type.inherits;
+        fmt::println("{} <- {}/{}{}", file.destination.generic_string(), plan.layers[file.layer], file.entry.path, file.entry.verbatim ? " (verbatim)" : "");
     }
+}
 
-    friend void from_json(nlohmann::json const& json, Kind& type)
-    {
-        json.at("name").get_to(type.name);
-        if (json.count("features")) type.features = json.at("features").get<std::vector<Feature>>();
-        if (json.count("inherits")) type.inherits = json.at("inherits").get<std::vector<std::string>>();
-    };
-};
-
-struct Template
+template <class Fn>
+liberror::Result<void> with_trace(argparse::ArgumentParser const& parser, Fn&& fnRun)
 {
-    std::string name;
-    std::vector<Kind> kinds;
+    if (!parser.is_used("--trace")) return fnRun();
 
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Template, name, kinds);
-};
+    Tracer tracer {};
+    auto result = fnRun();
+    TRY(tracer.save(parser.get<std::string>("--trace")));
 
-struct Language
-{
-    std::string name;
-    std::vector<int> standards;
-    std::vector<Template> templates;
-
-    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Language, name, standards, templates);
-};
+    return result;
+}
 
-liberror::Result<void> sanitize_argument_values(argparse::ArgumentParser const& parser, std::vector<Language> const& languages)
+liberror::Result<void> create_project(Configuration const& configuration, Pack const& pack, RenderOptions const& options, ThreadPool& pool)
 {
-    auto maybeLanguage = std::ranges::find(languages, parser.get<std::string>("--lang"), &Language::name);
-    if (maybeLanguage == languages.end())
-    {
-        return liberror::make_error("Language {} is not available.", parser.get<std::string>("--lang"));
-    }
-
-    if (std::ranges::find(maybeLanguage->standards, parser.get<int>("--std")) == maybeLanguage->standards.end())
-    {
-        return liberror::make_error("Standard {} is not available for {}.", parser.get<int>("--std"), parser.get<std::string>("--lang"));
-    }
+    namespace fs = std::filesystem;
 
-    auto maybeTemplate = std::ranges::find(maybeLanguage->templates, parser.get<std::string>("type"), &Template::name);
-    if (maybeTemplate == maybeLanguage->templates.end())
+    if (fs::exists(configuration.name))
     {
-        return liberror::make_error("Template \"{}\" could not be found.", parser.get<std::string>("type"));
+        return liberror::make_error("Project \"{}\" already exists.", configuration.name);
     }
 
-    auto maybeTemplateKind = std::ranges::find(maybeTemplate->kinds, parser.get<std::string>("--kind"), &Kind::name);
-    if (maybeTemplateKind == maybeTemplate->kinds.end())
-    {
-        return liberror::make_error("Kind \"{}\" is not avaiable for template \"{}\"", parser.get<std::string>("--kind"), parser.get<std::string>("type"));
-    }
+    auto const context = make_render_context(configuration, options);
+    auto const plan = plan_project(configuration, pack, context);
 
-    auto features = parser.get<std::vector<std::string>>("--features");
-    auto maybeFeature = std::ranges::find_if(features, [&] (std::string const& featureName) {
-        auto fnIsPresent = [&] {
-            return fplus::is_elem_of(featureName, fplus::transform(std::bind_front(&Feature::name), *maybeTemplateKind->features));
-        };
-        return !((maybeTemplateKind->features.has_value() && fnIsPresent()) || [&] (this auto&& self, Kind const& kind) {
-            if (!kind.inherits.has_value()) return false;
-            auto isPresent = false;
-            for (auto const& inheritName : *kind.inherits)
-            {
-                if (isPresent) break;
-                auto const& inherit = *std::ranges::find(maybeTemplate->kinds, inheritName, &Kind::name);
-                if (inherit.features.has_value())
-                    isPresent |= fplus::is_elem_of(featureName, fplus::transform(std::bind_front(&Feature::name), *inherit.features));
-                if (inherit.inherits.has_value())
-                    isPresent |= self(inherit);
-            }
-            return isPresent;
-        }(*maybeTemplateKind));
-    });
-    if (maybeFeature != features.end())
-    {
-        return liberror::make_error("Feature \"{}\" is not available for template of kind \"{}\"", *maybeFeature, parser.get<std::string>("--kind"));
-    }
+    TRY(generate_project(pack, plan, configuration, context, pool));
 
     return {};
 }
 
-struct Configuration
-{
-    std::string name;
-    std::string language;
-    std::string standard;
-    std::string type;
-    std::string kind;
-    std::vector<std::string> features;
-};
-
-std::vector<std::string> collect_feature_required_features(Kind const& kind, std::string_view featureName)
+// Creates an empty file next to `path` under a name no other process uses, so runs writing the
+// same file at the same time never write into each other's temporary file.
+liberror::Result<std::filesystem::path> create_temporary_file(std::filesystem::path const& path)
 {
-    std::vector<std::string> requirez {};
-    if (!kind.features.has_value()) return requirez;
+    std::random_device random {};
 
-    auto maybeFeature = std::ranges::find(*kind.features, featureName, &Feature::name);
-    if (maybeFeature != kind.features->end() && maybeFeature->requirez.has_value())
+    for (auto attempt = 0; attempt < 16; attempt += 1)
     {
-        std::ranges::copy(*maybeFeature->requirez, std::back_inserter(requirez));
-    }
-
-    return requirez;
-}
+        auto const temporary = std::filesystem::path(path).concat(fmt::format(".{:08x}.tmp", random()));
+        auto const descriptor = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
 
-std::vector<std::string> collect_features(Kind const& kind)
-{
-    std::vector<std::string> features {};
-    if (!kind.features.has_value()) return features;
+        if (descriptor != -1)
+        {
+            ::close(descriptor);
+            return temporary;
+        }
 
-    for (auto const& feature : fplus::drop_if(std::bind_front(&Feature::optional), *kind.features))
-    {
-        if (feature.requirez.has_value())
-            std::ranges::copy(*feature.requirez, std::back_inserter(features));
-        features.push_back(feature.name);
+        if (errno != EEXIST)
+        {
+            return liberror::make_error("Couldn't create \"{}\": {}.", temporary.string(), std::strerror(errno));
+        }
     }
 
-    return features;
+    return liberror::make_error("Couldn't create a temporary file next to \"{}\".", path.string());
 }
 
-Configuration configure_project(argparse::ArgumentParser const& parser, std::vector<Language> const& languages)
+liberror::Result<void> archive_project(Configuration const& configuration, Pack const& pack, std::filesystem::path const& output, ThreadPool& pool)
 {
-    using namespace std::literals;
+    namespace fs = std::filesystem;
 
-    Configuration configuration {
-        .name = parser.get<std::string>("--name"),
-        .language = parser.get<std::string>("--lang"),
-        .standard = [&] () {
-            std::stringstream stream {};
-            stream << parser.get<int>("--std");
-            return stream.str();
-        }(),
-        .type = parser.get<std::string>("type"),
-        .kind = parser.get<std::string>("--kind"),
-        .features = parser.get<std::vector<std::string>>("--features")
-    };
+    auto const context = make_render_context(configuration);
+    auto const plan = plan_project(configuration, pack, context);
 
-    auto projectLanguage = *std::ranges::find(languages, configuration.language, &Language::name);
-    auto projectTemplate = *std::ranges::find(projectLanguage.templates, configuration.type, &Template::name);
-    auto projectKind = *std::ranges::find(projectTemplate.kinds, configuration.kind, &Kind::name);
+    if (output == "-")
+    {
+        return write_archive(pack, plan, configuration, context, pool, std::cout);
+    }
 
-    configuration.features = fplus::nub(fplus::transform_and_concat([&] (auto&& featureName) -> std::vector<std::string> {
-        std::vector<std::string> requirez {};
-        std::ranges::copy([&] (this auto&& self, Kind const& kind) {
-            auto requirez = collect_feature_required_features(kind, featureName);
-            if (!kind.inherits.has_value()) return requirez;
-            for (auto const& inheritName : *kind.inherits)
-            {
-                auto const& inheritKind = *std::ranges::find(projectTemplate.kinds, inheritName, &Kind::name);
-                std::ranges::copy(self(inheritKind), std::back_inserter(requirez));
-            }
-            return requirez;
-        }(projectKind), std::back_inserter(requirez));
-        requirez.push_back(featureName);
-        return requirez;
-    }, configuration.features));
+    auto const temporary = TRY(create_temporary_file(output));
 
-    if (projectKind.features.has_value())
     {
-        auto features = fplus::nub(collect_features(projectKind));
-        features = fplus::drop_if([&] (auto&& feature) { return fplus::is_elem_of(feature, configuration.features); }, features);
-        configuration.features.insert(configuration.features.end(), features.begin(), features.end());
+        std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+        if (!stream)
+        {
+            std::error_code error {};
+            fs::remove(temporary, error);
+            return liberror::make_error("Couldn't open \"{}\".", temporary.string());
+        }
+
+        if (auto result = write_archive(pack, plan, configuration, context, pool, stream); !result.has_value())
+        {
+            stream.close();
+            std::error_code error {};
+            fs::remove(temporary, error);
+            return result;
+        }
     }
 
-    if (projectKind.inherits.has_value())
+    std::error_code error {};
+    fs::rename(temporary, output, error);
+
+    if (error)
     {
-        auto inheritedFeatures = fplus::nub(fplus::transform_and_concat([&] (std::string const& inheritedName) {
-            Kind const& inherited = *std::ranges::find(projectTemplate.kinds, inheritedName, &Kind::name);
-            return [&] (this auto&& self, Kind const& kind) {
-                auto features = collect_features(kind);
-                if (!kind.inherits.has_value()) return features;
-                for (auto const& subInheritedName : *kind.inherits)
-                {
-                    auto const& subInherited = *std::ranges::find(projectTemplate.kinds, subInheritedName, &Kind::name);
-                    std::ranges::copy(self(subInherited), std::back_inserter(features));
-                }
-                return features;
-            }(inherited);
-        }, *projectKind.inherits));
-
-        inheritedFeatures = fplus::drop_if([&] (auto&& feature) { return fplus::is_elem_of(feature, configuration.features); }, inheritedFeatures);
-        configuration.features.insert(configuration.features.end(), inheritedFeatures.begin(), inheritedFeatures.end());
+        std::error_code ignored {};
+        fs::remove(temporary, ignored);
+        return liberror::make_error("Couldn't write to \"{}\": {}", output.string(), error.message());
     }
 
-    return configuration;
+    return {};
 }
 
-liberror::Result<bool> copy_files(std::filesystem::path const& source, std::filesystem::path const& destination)
+liberror::Result<void> batch_main(std::span<char const*> arguments)
 {
-    namespace fs = std::filesystem;
+    argparse::ArgumentParser parser(PROJECT_NAME " batch", "", argparse::default_arguments::help);
 
-    if (!fs::exists(source)) return false;
+    parser.add_description("Create every project listed in a manifest.");
+
+    parser.add_argument("manifest").help("JSON array or JSON lines file with one project per entry");
+    parser.add_argument("--link").help("hard link files that need no rendering to the installed templates instead of copying them").flag();
+    parser.add_argument("--io").help("how files are written, uring falls back to blocking where io_uring isn't available").choices("blocking", "uring").default_value("blocking");
+    parser.add_argument("--compiled-directives").help("evaluate the directives compiled into the template cache instead of running the preprocessor").flag();
+    parser.add_argument("-j", "--jobs").help("number of files rendered in parallel").scan<'i', int>().default_value(static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)));
+    parser.add_argument("--trace").help("write a Chrome trace of the run to the given file");
 
     try
     {
-        fs::copy(source, destination, fs::copy_options::recursive | fs::copy_options::overwrite_existing);
+        parser.parse_args(static_cast<int>(arguments.size()), arguments.data());
     }
     catch (std::exception const& exception)
     {
         return liberror::make_error(exception.what());
     }
 
-    return true;
-}
-
-liberror::Result<void> copy_feature_files(Configuration const& configuration, Feature const& feature)
-{
-    namespace fs = std::filesystem;
-
-    auto isRequired = !feature.optional;
-    auto isPresent = std::ranges::find(configuration.features, feature.name) != configuration.features.end();
-    if (isRequired || isPresent)
+    if (parser.get<int>("--jobs") < 1)
     {
-        if (fs::exists(get_application_data_path() / "features" / feature.name))
-            TRY(copy_files(get_application_data_path() / "features" / feature.name, configuration.name));
+        return liberror::make_error("Job count must be at least 1, got {}.", parser.get<int>("--jobs"));
     }
 
-    return {};
-}
+    return with_trace(parser, [&] () -> liberror::Result<void> {
+        auto entries = TRY(load_batch(parser.get<std::string>("manifest")));
+        auto const pack = TRY(Pack::open(get_application_data_path(), get_application_config_path() / "catalog.pack"));
 
-liberror::Result<void> create_project_structure(Configuration const& configuration, Template const& projectTemplate, Kind const& projectKind)
-{
-    namespace fs = std::filesystem;
-
-    if (fs::exists(configuration.name))
-    {
-        return liberror::make_error("Project \"{}\" already exists.", configuration.name);
-    }
+        ThreadPool pool(static_cast<std::size_t>(parser.get<int>("--jobs")));
+        PreprocessorCache preprocessed {};
+        RenderOptions const options { .linkVerbatim = parser.get<bool>("--link"), .io = parse_io_backend(parser), .preprocessed = &preprocessed, .compiledDirectives = parser.get<bool>("--compiled-directives") };
 
-    TRY([&] (this auto&& self, auto&& kind) -> liberror::Result<void> {
-        if (!kind.inherits.has_value()) return {};
+        std::size_t failures = 0;
 
-        for (auto const& inherited : *kind.inherits)
+        for (std::size_t index = 0; index < entries.size(); index += 1)
         {
-            TRY(copy_files(get_application_data_path() / "templates" / configuration.type / inherited, configuration.name));
-            auto parent = *std::ranges::find(projectTemplate.kinds, inherited, &Kind::name);
-            if (parent.features.has_value())
+            auto result = [&] () -> liberror::Result<void> {
+                auto entry = TRY(std::move(entries[index]));
+                auto const configuration = TRY(configure_project(std::move(entry), pack.catalog()));
+                TRY(create_project(configuration, pack, options, pool));
+                return {};
+            }();
+
+            if (!result.has_value())
             {
-                for (auto const& feature : *parent.features)
-                    TRY(copy_feature_files(configuration, feature));
-            }
-            else
-            {
-                TRY(self(parent));
+                failures += 1;
+                fmt::println("Entry {}: {}", index + 1, result.error().message());
             }
         }
 
-        return {};
-    }(projectKind));
-
-    TRY(copy_files(get_application_data_path() / "templates" / configuration.type / configuration.kind, configuration.name));
-
-    if (projectKind.features.has_value())
-    {
-        for (auto const& feature : *projectKind.features)
-            TRY(copy_feature_files(configuration, feature));
-    }
+        if (failures != 0)
+        {
+            return liberror::make_error("{} of {} projects couldn't be created.", failures, entries.size());
+        }
 
-    return {};
+        return {};
+    });
 }
 
-std::string replace(std::string content, std::pair<std::string, std::string> const& wildcard)
+liberror::Result<void> update_main(std::span<char const*> arguments)
 {
-    for (auto position = content.find(wildcard.first); position != std::string::npos; position = content.find(wildcard.first))
-    {
-        auto first = std::next(content.begin(), static_cast<int>(position));
-        auto last = std::next(first, static_cast<int>(wildcard.first.size()));
-        content.replace(first, last, wildcard.second);
-    }
+    argparse::ArgumentParser parser(PROJECT_NAME " update", "", argparse::default_arguments::help);
 
-    return content;
-}
+    parser.add_description("Bring a project created by cmaker up to date with its templates.");
 
-void replace_filename_wildcards(std::filesystem::path const& path, std::unordered_map<std::string, std::string> const& wildcards)
-{
-    namespace fs = std::filesystem;
-
-    auto fnRename = [](auto&& entry, auto&& wildcard) {
-        auto path = entry.parent_path();
-        auto name = entry.filename().string();
-        fs::rename(entry, path.append(replace(name, wildcard)));
-    };
+    parser.add_argument("project").help("the project to be updated").default_value(".");
+    parser.add_argument("--features").help("features added to the project").nargs(argparse::nargs_pattern::at_least_one);
+    parser.add_argument("-j", "--jobs").help("number of files rendered in parallel").scan<'i', int>().default_value(static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)));
+    parser.add_argument("--trace").help("write a Chrome trace of the run to the given file");
 
-    for (auto const& entry : fs::directory_iterator(path) | std::views::transform(&fs::directory_entry::path))
+    try
     {
-        if (fs::is_directory(entry)) replace_filename_wildcards(entry, wildcards);
-        std::ranges::for_each(wildcards | std::views::filter([&](auto&& wildcard) {
-            return entry.filename().string().contains(wildcard.first);
-        }), std::bind_front(fnRename, entry));
+        parser.parse_args(static_cast<int>(arguments.size()), arguments.data());
+    }
+    catch (std::exception const& exception)
+    {
+        return liberror::make_error(exception.what());
     }
-}
-
-void replace_file_wildcards(std::filesystem::path const& path, std::unordered_map<std::string, std::string> const& wildcards)
-{
-    namespace fs = std::filesystem;
-
-    auto fnReplace = [](auto&& entry, auto&& wildcard) {
-        std::stringstream contentStream {};
-        contentStream << std::ifstream(entry).rdbuf();
-        std::ofstream outputStream(entry, std::ios::trunc);
-        outputStream << replace(contentStream.str(), wildcard);
-    };
 
-    for (auto const& entry : fs::recursive_directory_iterator(path) | std::views::transform(&fs::directory_entry::path))
+    if (parser.get<int>("--jobs") < 1)
     {
-        if (!fs::is_regular_file(entry)) continue;
-        std::ranges::for_each(wildcards, std::bind_front(fnReplace, entry));
+        return liberror::make_error("Job count must be at least 1, got {}.", parser.get<int>("--jobs"));
     }
-}
 
-liberror::Result<void> preprocess_project_files(Configuration const& configuration)
-{
-    namespace fs = std::filesystem;
-    using namespace std::literals;
+    return with_trace(parser, [&] () -> liberror::Result<void> {
+        auto const project = std::filesystem::path(parser.get<std::string>("project"));
+        auto const manifest = TRY(load_manifest(project));
+        auto const pack = TRY(Pack::open(get_application_data_path(), get_application_config_path() / "catalog.pack"));
 
-    libpreprocessor::PreprocessorContext context {
-        .environmentVariables = {
-            { "ENV:LANGUAGE", configuration.language },
-            { "ENV:STANDARD", configuration.standard },
-            { "ENV:KIND", configuration.type },
-            { "ENV:MODE", configuration.kind },
-            { "ENV:FEATURES", fplus::join(","s, configuration.features) }
+        auto requested = manifest.configuration;
+        for (auto const& feature : parser.get<std::vector<std::string>>("--features"))
+        {
+            if (std::ranges::find(requested.features, feature) == requested.features.end()) requested.features.push_back(feature);
         }
-    };
 
-    for (auto const& entry : fs::recursive_directory_iterator(configuration.name) | std::views::transform(&fs::directory_entry::path))
-    {
-        if (!fs::is_regular_file(entry)) continue;
-        auto const content = TRY(libpreprocessor::process(entry, context));
-        std::ofstream outputStream(entry);
-        outputStream << content;
-    }
+        auto const configuration = TRY(configure_project(std::move(requested), pack.catalog()));
+        auto const context = make_render_context(configuration);
+        auto const plan = plan_project(configuration, pack, context);
 
-    static std::unordered_map<std::string, std::string> const& wildcards {
-        { "!PROJECT!", configuration.name },
-        { "!LANGUAGE!", configuration.language },
-        { "!STANDARD!", configuration.standard }
-    };
+        ThreadPool pool(static_cast<std::size_t>(parser.get<int>("--jobs")));
+        auto const report = TRY(update_project(pack, plan, configuration, manifest, project, context, pool));
 
-    replace_filename_wildcards(configuration.name, wildcards);
-    replace_file_wildcards(configuration.name, wildcards);
+        for (auto const& path : report.updated) fmt::println("updated {}", path);
+        for (auto const& path : report.skipped) fmt::println("skipped {}, it was changed since it was generated", path);
 
-    return {};
+        return {};
+    });
 }
 
-liberror::Result<void> create_project(Configuration const& configuration, std::vector<Language> const& languages)
+liberror::Result<void> safe_main(std::span<char const*> arguments)
 {
-    auto projectLanguage = *std::ranges::find(languages, configuration.language, &Language::name);
-    auto projectTemplate = *std::ranges::find(projectLanguage.templates, configuration.type, &Template::name);
-    auto projectKind = *std::ranges::find(projectTemplate.kinds, configuration.kind, &Kind::name);
+    using namespace std::literals;
 
-    TRY(create_project_structure(configuration, projectTemplate, projectKind));
-    TRY(preprocess_project_files(configuration));
+    if (arguments.size() > 1 && arguments[1] == "batch"sv)
+    {
+        return batch_main(arguments.subspan(1));
+    }
 
-    return {};
-}
+    if (arguments.size() > 1 && arguments[1] == "update"sv)
+    {
+        return update_main(arguments.subspan(1));
+    }
 
-liberror::Result<void> safe_main(std::span<char const*> arguments)
-{
     argparse::ArgumentParser parser(PROJECT_NAME, "", argparse::default_arguments::help);
 
     parser.add_description("Create C++ and C projects.");
@@ -415,6 +304,14 @@ liberror::Result<void> safe_main(std::span<char const*> arguments)
     parser.add_argument("-l", "--lang").default_value("c++");
     parser.add_argument("--std").scan<'i', int>().default_value(23);
     parser.add_argument("--features").help("features used in the project").nargs(argparse::nargs_pattern::at_least_one);
+    parser.add_argument("--plan").help("print where every file of the project comes from without creating it").flag();
+    parser.add_argument("--link").help("hard link files that need no rendering to the installed templates instead of copying them").flag();
+    parser.add_argument("--io").help("how files are written, uring falls back to blocking where io_uring isn't available").choices("blocking", "uring").default_value("blocking");
+    parser.add_argument("--compiled-directives").help("evaluate the directives compiled into the template cache instead of running the preprocessor").flag();
+    parser.add_argument("-o", "--output").help("write the project as a tar archive to the given file, or to the standard output with -, instead of creating it");
+    parser.add_argument("--watch").help("keep the project up to date with the templates while they are edited, creating it when needed").flag();
+    parser.add_argument("-j", "--jobs").help("number of files rendered in parallel").scan<'i', int>().default_value(static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u)));
+    parser.add_argument("--trace").help("write a Chrome trace of the run to the given file");
 
     try
     {
@@ -425,15 +322,44 @@ liberror::Result<void> safe_main(std::span<char const*> arguments)
         return liberror::make_error(exception.what());
     }
 
-    std::vector<Language> languages {};
-    nlohmann::json languagesJson = nlohmann::json::parse(std::ifstream(get_application_data_path() / "languages.json"));
-    std::ranges::copy(languagesJson["languages"], std::back_inserter(languages));
+    if (parser.get<int>("--jobs") < 1)
+    {
+        return liberror::make_error("Job count must be at least 1, got {}.", parser.get<int>("--jobs"));
+    }
+
+    if (parser.get<bool>("--watch") && (parser.get<bool>("--plan") || parser.get<bool>("--link") || parser.is_used("--output") || parser.is_used("--trace")))
+    {
+        return liberror::make_error("--watch can't be used with --plan, --link, --output or --trace.");
+    }
+
+    if (parser.get<bool>("--watch"))
+    {
+        ThreadPool pool(static_cast<std::size_t>(parser.get<int>("--jobs")));
+        return watch_project(parse_configuration(parser), get_application_data_path(), get_application_config_path() / "catalog.pack", { .io = parse_io_backend(parser), .compiledDirectives = parser.get<bool>("--compiled-directives") }, pool);
+    }
 
-    TRY(sanitize_argument_values(parser, languages));
-    auto configuration = configure_project(parser, languages);
-    TRY(create_project(configuration, languages));
+    return with_trace(parser, [&] () -> liberror::Result<void> {
+        auto const pack = TRY(Pack::open(get_application_data_path(), get_application_config_path() / "catalog.pack"));
+        auto const configuration = TRY(configure_project(parse_configuration(parser), pack.catalog()));
 
-    return {};
+        if (parser.get<bool>("--plan"))
+        {
+            print_plan(plan_project(configuration, pack, make_render_context(configuration)));
+            return {};
+        }
+
+        ThreadPool pool(static_cast<std::size_t>(parser.get<int>("--jobs")));
+
+        if (parser.is_used("--output"))
+        {
+            TRY(archive_project(configuration, pack, parser.get<std::string>("--output"), pool));
+            return {};
+        }
+
+        TRY(create_project(configuration, pack, { .linkVerbatim = parser.get<bool>("--link"), .io = parse_io_backend(parser), .compiledDirectives = parser.get<bool>("--compiled-directives") }, pool));
+
+        return {};
+    });
 }
 
 int main(int argc, char const** argv)
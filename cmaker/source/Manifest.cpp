@@ -0,0 +1,97 @@
+#include "Manifest.hpp"
+
+#include "Hash.hpp"
+#include "Trace.hpp"
+
+#include <fstream>
+
+std::uint64_t hash_context(Configuration const& configuration)
+{
+    auto context = hash(configuration.name);
+
+    for (auto const& value : { configuration.language, configuration.standard, configuration.type, configuration.kind })
+    {
+        context = hash(value, hash("\n", context));
+    }
+
+    for (auto const& feature : configuration.features)
+    {
+        context = hash(feature, hash(",", context));
+    }
+
+    return context;
+}
+
+Manifest make_manifest(Configuration const& configuration, Plan const& plan, std::span<std::uint64_t const> outputs)
+{
+    Manifest manifest { .configuration = configuration, .files = {} };
+    auto const context = hash_context(configuration);
+
+    for (std::size_t index = 0; index < plan.files.size(); index += 1)
+    {
+        auto const& file = plan.files[index];
+        manifest.files[file.destination.generic_string()] = {
+            .source = plan.layers[file.layer] + "/" + std::string(file.entry.path),
+            .context = context,
+            .content = file.entry.hash,
+            .output = outputs[index]
+        };
+    }
+
+    return manifest;
+}
+
+liberror::Result<Manifest> load_manifest(std::filesystem::path const& project)
+{
+    TraceSpan span("load manifest");
+
+    auto const path = project / Manifest::FILE_NAME;
+
+    std::ifstream stream(path);
+    if (!stream)
+    {
+        return liberror::make_error("Couldn't open \"{}\", was the project generated by cmaker?", path.string());
+    }
+
+    try
+    {
+        return nlohmann::json::parse(stream).get<Manifest>();
+    }
+    catch (std::exception const& exception)
+    {
+        return liberror::make_error("Couldn't parse \"{}\": {}", path.string(), exception.what());
+    }
+}
+
+std::string serialize_manifest(Manifest const& manifest)
+{
+    return nlohmann::json(manifest).dump(4) + '\n';
+}
+
+liberror::Result<void> save_manifest(Manifest const& manifest, std::filesystem::path const& project)
+{
+    namespace fs = std::filesystem;
+
+    auto const path = project / Manifest::FILE_NAME;
+    auto const temporary = fs::path(path).concat(".tmp");
+
+    {
+        std::ofstream stream(temporary, std::ios::trunc);
+        stream << serialize_manifest(manifest);
+
+        if (!stream)
+        {
+            return liberror::make_error("Couldn't write to \"{}\".", temporary.string());
+        }
+    }
+
+    std::error_code error {};
+    fs::rename(temporary, path, error);
+
+    if (error)
+    {
+        return liberror::make_error("Couldn't write to \"{}\": {}", path.string(), error.message());
+    }
+
+    return {};
+}
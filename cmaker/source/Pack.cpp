@@ -0,0 +1,796 @@
+#include "Pack.hpp"
+
+#include "Directives.hpp"
+#include "Hash.hpp"
+#include "Render.hpp"
+#include "Resources.hpp"
+#include "Trace.hpp"
+
+#include <liberror/Try.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::array<char, 8> MAGIC { 'C', 'M', 'K', 'P', 'A', 'C', 'K', '\0' };
+// Bump whenever the layout or the meaning of a field changes, including the set of wildcards
+// `is_verbatim` looks for and the directives `compile_directives` understands.
+constexpr std::uint32_t VERSION = 5;
+
+struct Header
+{
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t layerCapacity;
+    std::uint64_t stamp;
+    std::uint64_t catalogOffset;
+    std::uint64_t catalogSize;
+    std::uint64_t layersOffset;
+    std::uint64_t entriesOffset;
+    std::uint64_t entryCount;
+    std::uint64_t stringsOffset;
+    std::uint64_t stringsSize;
+    std::uint64_t blobOffset;
+    std::uint64_t blobSize;
+    std::uint64_t programsOffset;
+    std::uint64_t programsSize;
+};
+
+struct LayerRecord
+{
+    std::uint64_t hash;
+    std::uint32_t nameOffset;
+    std::uint32_t nameSize;
+    std::uint32_t firstEntry;
+    std::uint32_t entryCount;
+};
+
+struct EntryRecord
+{
+    std::uint32_t pathOffset;
+    std::uint32_t pathSize;
+    std::uint32_t permissions;
+    std::uint16_t directory;
+    std::uint8_t verbatim;
+    std::uint8_t embedded;
+    std::uint64_t contentOffset;
+    std::uint64_t contentSize;
+    std::uint64_t contentHash;
+    std::uint32_t programOffset;
+    std::uint32_t programSize;
+};
+
+template <class T>
+std::string_view as_bytes(T const& value)
+{
+    return { reinterpret_cast<char const*>(&value), sizeof(T) };
+}
+
+std::vector<std::filesystem::path> collect_tree(std::filesystem::path const& root)
+{
+    namespace fs = std::filesystem;
+
+    std::vector<fs::path> entries {};
+    if (!fs::is_directory(root)) return entries;
+
+    for (auto const& entry : fs::recursive_directory_iterator(root))
+    {
+        entries.push_back(entry.path().lexically_relative(root));
+    }
+
+    std::ranges::sort(entries);
+    return entries;
+}
+
+// A file or folder the pack is built from. Resources compiled into the executable come first and
+// the data directory overrides them path by path, so it can add or replace single templates.
+struct Source
+{
+    bool directory;
+    std::filesystem::perms permissions;
+    std::string_view embedded;
+    std::filesystem::path disk;
+};
+
+std::map<std::filesystem::path, Source> collect_sources(std::filesystem::path const& dataPath)
+{
+    namespace fs = std::filesystem;
+
+    std::map<fs::path, Source> sources {};
+
+    for (auto const& resource : embedded_resources())
+    {
+        sources[resource.path] = {
+            .directory = resource.directory,
+            .permissions = resource.directory ? fs::perms(0755) : fs::perms(0644),
+            .embedded = resource.content,
+            .disk = {}
+        };
+    }
+
+    auto fnDisk = [&] (fs::path const& relative) {
+        auto const path = dataPath / relative;
+        auto const status = fs::status(path);
+        if (!fs::is_directory(status) && !fs::is_regular_file(status)) return;
+        sources[relative] = { .directory = fs::is_directory(status), .permissions = status.permissions(), .embedded = {}, .disk = path };
+    };
+
+    fnDisk("languages.json");
+
+    for (auto const& root : { "templates", "features" })
+    {
+        for (auto const& relative : collect_tree(dataPath / root))
+        {
+            fnDisk(fs::path(root) / relative);
+        }
+    }
+
+    return sources;
+}
+
+// `templates/<type>/<kind>` and `features/<feature>`.
+std::vector<std::string> collect_layer_roots(std::map<std::filesystem::path, Source> const& sources)
+{
+    std::vector<std::string> roots {};
+
+    for (auto const& [path, source] : sources)
+    {
+        if (!source.directory) continue;
+
+        auto const depth = std::distance(path.begin(), path.end());
+        auto const& root = *path.begin();
+        if ((root == "templates" && depth == 3) || (root == "features" && depth == 2)) roots.push_back(path.generic_string());
+    }
+
+    std::ranges::sort(roots);
+    return roots;
+}
+
+std::uint64_t compute_stamp(std::filesystem::path const& dataPath)
+{
+    namespace fs = std::filesystem;
+
+    auto stamp = hash(as_bytes(VERSION));
+    stamp = hash(as_bytes(embedded_resources_stamp()), stamp);
+
+    // One stat per file, which is most of what opening an up to date pack costs. Symlinks are
+    // followed, like `collect_sources` does, so editing the file one points to is noticed too.
+    auto fnStamp = [&] (fs::path const& path, std::string_view relative) {
+        struct stat status {};
+        if (::stat(path.c_str(), &status) != 0) return;
+        auto const type = status.st_mode & S_IFMT;
+        auto const modified = std::array { static_cast<std::int64_t>(status.st_mtim.tv_sec), static_cast<std::int64_t>(status.st_mtim.tv_nsec) };
+        auto const size = S_ISREG(status.st_mode) ? static_cast<std::int64_t>(status.st_size) : std::int64_t {};
+        stamp = hash(relative, stamp);
+        stamp = hash(as_bytes(type), stamp);
+        stamp = hash(as_bytes(modified), stamp);
+        stamp = hash(as_bytes(size), stamp);
+    };
+
+    fnStamp(dataPath / "languages.json", "languages.json");
+
+    for (auto const& root : { "templates", "features" })
+    {
+        for (auto const& relative : collect_tree(dataPath / root))
+        {
+            fnStamp(dataPath / root / relative, (fs::path(root) / relative).generic_string());
+        }
+    }
+
+    return stamp;
+}
+
+void write_u32(std::string& output, std::uint32_t value)
+{
+    output.append(as_bytes(value));
+}
+
+void write_string(std::string& output, std::string_view value)
+{
+    write_u32(output, static_cast<std::uint32_t>(value.size()));
+    output.append(value);
+}
+
+void write_strings(std::string& output, std::optional<std::vector<std::string>> const& values)
+{
+    output.push_back(values.has_value());
+    if (!values.has_value()) return;
+    write_u32(output, static_cast<std::uint32_t>(values->size()));
+    for (auto const& value : *values) write_string(output, value);
+}
+
+std::string serialize_catalog(std::vector<Language> const& languages)
+{
+    std::string output {};
+
+    write_u32(output, static_cast<std::uint32_t>(languages.size()));
+    for (auto const& language : languages)
+    {
+        write_string(output, language.name);
+        write_u32(output, static_cast<std::uint32_t>(language.standards.size()));
+        for (auto const standard : language.standards) write_u32(output, static_cast<std::uint32_t>(standard));
+
+        write_u32(output, static_cast<std::uint32_t>(language.templates.size()));
+        for (auto const& projectTemplate : language.templates)
+        {
+            write_string(output, projectTemplate.name);
+            write_u32(output, static_cast<std::uint32_t>(projectTemplate.kinds.size()));
+            for (auto const& kind : projectTemplate.kinds)
+            {
+                write_string(output, kind.name);
+                output.push_back(kind.features.has_value());
+                if (kind.features.has_value())
+                {
+                    write_u32(output, static_cast<std::uint32_t>(kind.features->size()));
+                    for (auto const& feature : *kind.features)
+                    {
+                        write_string(output, feature.name);
+                        output.push_back(feature.optional);
+                        write_strings(output, feature.requirez);
+                    }
+                }
+                write_strings(output, kind.inherits);
+            }
+        }
+    }
+
+    return output;
+}
+
+class Reader
+{
+public:
+    explicit Reader(std::string_view data) : m_data(data) {}
+
+    bool failed() const { return m_failed; }
+
+    std::string_view take(std::size_t size)
+    {
+        if (m_failed || m_data.size() - m_position < size)
+        {
+            m_failed = true;
+            return {};
+        }
+
+        auto const bytes = m_data.substr(m_position, size);
+        m_position += size;
+        return bytes;
+    }
+
+    std::uint32_t u32()
+    {
+        std::uint32_t value {};
+        auto const bytes = take(sizeof value);
+        if (!m_failed) std::memcpy(&value, bytes.data(), sizeof value);
+        return value;
+    }
+
+    // Every serialized element takes at least one byte, so a count larger than what is left can
+    // only come from a corrupted pack and must not turn into a huge allocation.
+    std::uint32_t count()
+    {
+        auto const value = u32();
+        if (value > m_data.size() - m_position) m_failed = true;
+        return m_failed ? 0 : value;
+    }
+
+    bool flag()
+    {
+        auto const bytes = take(1);
+        return !m_failed && bytes.front() != 0;
+    }
+
+    std::string string()
+    {
+        return std::string(take(u32()));
+    }
+
+    std::optional<std::vector<std::string>> strings()
+    {
+        if (!flag()) return std::nullopt;
+        std::vector<std::string> values(count());
+        for (auto& value : values) value = string();
+        return values;
+    }
+
+private:
+    std::string_view m_data;
+    std::size_t m_position { 0 };
+    bool m_failed { false };
+};
+
+std::vector<Language> deserialize_catalog(Reader& reader)
+{
+    std::vector<Language> languages(reader.count());
+    for (auto& language : languages)
+    {
+        language.name = reader.string();
+        language.standards.resize(reader.count());
+        for (auto& standard : language.standards) standard = static_cast<int>(reader.u32());
+
+        language.templates.resize(reader.count());
+        for (auto& projectTemplate : language.templates)
+        {
+            projectTemplate.name = reader.string();
+            projectTemplate.kinds.resize(reader.count());
+            for (auto& kind : projectTemplate.kinds)
+            {
+                kind.name = reader.string();
+                if (reader.flag())
+                {
+                    kind.features = std::vector<Feature>(reader.count());
+                    for (auto& feature : *kind.features)
+                    {
+                        feature.name = reader.string();
+                        feature.optional = reader.flag();
+                        feature.requirez = reader.strings();
+                    }
+                }
+                kind.inherits = reader.strings();
+                if (reader.failed()) return {};
+            }
+        }
+    }
+
+    return languages;
+}
+
+std::uint64_t align(std::uint64_t offset)
+{
+    return (offset + 7) & ~std::uint64_t { 7 };
+}
+
+liberror::Result<std::string> build_image(std::filesystem::path const& dataPath, std::uint64_t stamp)
+{
+    auto const sources = collect_sources(dataPath);
+
+    auto fnRead = [&] (Source const& source, std::string& output) -> liberror::Result<void> {
+        if (source.disk.empty())
+        {
+            output.append(source.embedded);
+            return {};
+        }
+
+        std::ifstream stream(source.disk, std::ios::binary);
+        if (!stream)
+        {
+            return liberror::make_error("Couldn't open \"{}\".", source.disk.string());
+        }
+        output.append(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+        return {};
+    };
+
+    auto const languages = sources.find("languages.json");
+    if (languages == sources.end())
+    {
+        return liberror::make_error("Couldn't open \"{}\".", (dataPath / "languages.json").string());
+    }
+
+    std::string catalogContent {};
+    TRY(fnRead(languages->second, catalogContent));
+    auto const catalog = TRY(parse_catalog(catalogContent, languages->second.disk.empty() ? "languages.json" : languages->second.disk.string()));
+    auto const catalogBytes = serialize_catalog(catalog.languages());
+
+    std::string strings {};
+    std::string blob {};
+    std::vector<EntryRecord> entries {};
+    std::vector<LayerRecord> layers {};
+    std::vector<Instruction> programs {};
+    // Templates are shared between layers often enough that identical contents share a program.
+    std::unordered_map<std::uint64_t, std::pair<std::uint32_t, std::uint32_t>> compiled {};
+
+    for (auto const& root : collect_layer_roots(sources))
+    {
+        LayerRecord layer {
+            .hash = hash(root),
+            .nameOffset = static_cast<std::uint32_t>(strings.size()),
+            .nameSize = static_cast<std::uint32_t>(root.size()),
+            .firstEntry = static_cast<std::uint32_t>(entries.size()),
+            .entryCount = 0
+        };
+        strings.append(root);
+
+        // Everything under a folder sorts right after it.
+        auto const prefix = root + "/";
+        for (auto found = sources.upper_bound(root); found != sources.end() && found->first.generic_string().starts_with(prefix); ++found)
+        {
+            auto const& [path, source] = *found;
+
+            auto const name = path.generic_string().substr(prefix.size());
+            EntryRecord entry {
+                .pathOffset = static_cast<std::uint32_t>(strings.size()),
+                .pathSize = static_cast<std::uint32_t>(name.size()),
+                .permissions = static_cast<std::uint32_t>(source.permissions),
+                .directory = source.directory,
+                .verbatim = 0,
+                .embedded = source.disk.empty(),
+                .contentOffset = blob.size(),
+                .contentSize = 0,
+                .contentHash = hash({}),
+                .programOffset = 0,
+                .programSize = 0
+            };
+            strings.append(name);
+
+            if (!source.directory)
+            {
+                TRY(fnRead(source, blob));
+                entry.contentSize = blob.size() - entry.contentOffset;
+                auto const content = std::string_view(blob).substr(entry.contentOffset);
+                entry.verbatim = is_verbatim(content);
+                entry.contentHash = hash(content);
+
+                if (needs_preprocessing(content))
+                {
+                    auto [program, inserted] = compiled.try_emplace(entry.contentHash);
+                    if (inserted)
+                    {
+                        auto const instructions = compile_directives(content).value_or(std::vector<Instruction> {});
+                        program->second = { static_cast<std::uint32_t>(programs.size()), static_cast<std::uint32_t>(instructions.size()) };
+                        programs.insert(programs.end(), instructions.begin(), instructions.end());
+                    }
+                    std::tie(entry.programOffset, entry.programSize) = program->second;
+                }
+            }
+
+            entries.push_back(entry);
+            layer.entryCount += 1;
+        }
+
+        layers.push_back(layer);
+    }
+
+    auto const capacity = std::bit_ceil(std::max<std::size_t>(layers.size() * 2, 1));
+    std::vector<LayerRecord> table(capacity, LayerRecord {});
+    for (auto const& layer : layers)
+    {
+        auto slot = layer.hash & (capacity - 1);
+        while (table[slot].nameSize != 0) slot = (slot + 1) & (capacity - 1);
+        table[slot] = layer;
+    }
+
+    Header header {
+        .magic = MAGIC,
+        .version = VERSION,
+        .layerCapacity = static_cast<std::uint32_t>(capacity),
+        .stamp = stamp,
+        .catalogOffset = align(sizeof(Header)),
+        .catalogSize = catalogBytes.size(),
+        .layersOffset = 0,
+        .entriesOffset = 0,
+        .entryCount = entries.size(),
+        .stringsOffset = 0,
+        .stringsSize = strings.size(),
+        .blobOffset = 0,
+        .blobSize = blob.size(),
+        .programsOffset = 0,
+        .programsSize = programs.size()
+    };
+    header.layersOffset = align(header.catalogOffset + header.catalogSize);
+    header.entriesOffset = header.layersOffset + capacity * sizeof(LayerRecord);
+    header.stringsOffset = header.entriesOffset + entries.size() * sizeof(EntryRecord);
+    header.blobOffset = align(header.stringsOffset + header.stringsSize);
+    header.programsOffset = align(header.blobOffset + header.blobSize);
+
+    std::string image {};
+    image.reserve(header.programsOffset + programs.size() * sizeof(Instruction));
+    image.append(as_bytes(header));
+    image.resize(header.catalogOffset, '\0');
+    image.append(catalogBytes);
+    image.resize(header.layersOffset, '\0');
+    for (auto const& layer : table) image.append(as_bytes(layer));
+    for (auto const& entry : entries) image.append(as_bytes(entry));
+    image.append(strings);
+    image.resize(header.blobOffset, '\0');
+    image.append(blob);
+    image.resize(header.programsOffset, '\0');
+    for (auto const& instruction : programs) image.append(as_bytes(instruction));
+
+    return image;
+}
+
+// Writes the image under a name no other process uses and renames it over the pack, so processes
+// rebuilding it at the same time never write into each other's file.
+bool store_image(std::filesystem::path const& packPath, std::string_view image)
+{
+    namespace fs = std::filesystem;
+
+    std::error_code error {};
+    fs::create_directories(packPath.parent_path(), error);
+    if (error) return false;
+
+    auto temporary = packPath.string() + ".XXXXXX";
+    auto const descriptor = ::mkostemp(temporary.data(), O_CLOEXEC);
+    if (descriptor == -1) return false;
+
+    auto stored = true;
+    for (std::size_t offset = 0; stored && offset < image.size();)
+    {
+        auto const written = ::write(descriptor, image.data() + offset, image.size() - offset);
+        if (written == -1 && errno == EINTR) continue;
+        stored = written > 0;
+        if (stored) offset += static_cast<std::size_t>(written);
+    }
+
+    // mkostemp creates the file readable by its owner only.
+    stored = ::fchmod(descriptor, 0644) == 0 && stored;
+    stored = ::close(descriptor) == 0 && stored;
+
+    if (stored) fs::rename(temporary, packPath, error);
+
+    if (!stored || error)
+    {
+        fs::remove(temporary, error);
+        return false;
+    }
+
+    return true;
+}
+
+}
+
+liberror::Result<Pack> Pack::open(std::filesystem::path const& dataPath, std::filesystem::path const& packPath)
+{
+    TraceSpan span("open pack");
+
+    auto const stamp = TRY(Pack::stamp(dataPath));
+
+    if (auto pack = map(dataPath, packPath, stamp); pack.has_value())
+    {
+        return pack;
+    }
+
+    TraceSpan buildSpan("build pack");
+    auto image = TRY(build_image(dataPath, stamp));
+
+    // The pack is only a cache: when it can't be stored, or another process replaced it with one
+    // that doesn't match before it could be mapped, run from the image that was just built.
+    auto fnFromImage = [&] () -> liberror::Result<Pack> {
+        Pack pack {};
+        pack.m_dataPath = dataPath;
+        pack.m_image = std::move(image);
+        pack.m_data = pack.m_image.data();
+        pack.m_size = pack.m_image.size();
+        TRY(pack.load(stamp));
+        return pack;
+    };
+
+    if (!store_image(packPath, image)) return fnFromImage();
+
+    if (auto pack = map(dataPath, packPath, stamp); pack.has_value())
+    {
+        return pack;
+    }
+
+    return fnFromImage();
+}
+
+liberror::Result<std::uint64_t> Pack::stamp(std::filesystem::path const& dataPath)
+{
+    TraceSpan span("stamp data directory");
+
+    try
+    {
+        return compute_stamp(dataPath);
+    }
+    catch (std::exception const& exception)
+    {
+        return liberror::make_error(exception.what());
+    }
+}
+
+liberror::Result<Pack> Pack::map(std::filesystem::path const& dataPath, std::filesystem::path const& packPath, std::uint64_t stamp)
+{
+    auto const descriptor = ::open(packPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor == -1)
+    {
+        return liberror::make_error("Couldn't open \"{}\".", packPath.string());
+    }
+
+    struct stat status {};
+    auto const statResult = ::fstat(descriptor, &status);
+    auto* mapping = statResult == 0 && status.st_size > 0
+        ? ::mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0)
+        : MAP_FAILED;
+    ::close(descriptor);
+
+    if (mapping == MAP_FAILED)
+    {
+        return liberror::make_error("Couldn't map \"{}\".", packPath.string());
+    }
+
+    Pack pack {};
+    pack.m_dataPath = dataPath;
+    pack.m_data = static_cast<char const*>(mapping);
+    pack.m_size = static_cast<std::size_t>(status.st_size);
+    pack.m_mapped = true;
+    TRY(pack.load(stamp));
+
+    return pack;
+}
+
+liberror::Result<void> Pack::load(std::uint64_t stamp)
+{
+    Header header {};
+    if (m_size < sizeof header)
+    {
+        return liberror::make_error("Catalog pack is truncated.");
+    }
+    std::memcpy(&header, m_data, sizeof header);
+
+    auto fnFits = [&] (std::uint64_t offset, std::uint64_t size) {
+        return offset <= m_size && size <= m_size - offset;
+    };
+
+    if (header.magic != MAGIC || header.version != VERSION || header.stamp != stamp)
+    {
+        return liberror::make_error("Catalog pack is out of date.");
+    }
+
+    if (!std::has_single_bit(header.layerCapacity)
+        || !fnFits(header.catalogOffset, header.catalogSize)
+        || !fnFits(header.layersOffset, std::uint64_t { header.layerCapacity } * sizeof(LayerRecord))
+        || !fnFits(header.entriesOffset, header.entryCount * sizeof(EntryRecord))
+        || !fnFits(header.stringsOffset, header.stringsSize)
+        || !fnFits(header.blobOffset, header.blobSize)
+        || !fnFits(header.programsOffset, header.programsSize * sizeof(Instruction))
+        || header.programsOffset % alignof(Instruction) != 0)
+    {
+        return liberror::make_error("Catalog pack is corrupted.");
+    }
+
+    Reader reader(bytes(header.catalogOffset, header.catalogSize));
+    auto languages = deserialize_catalog(reader);
+    if (reader.failed())
+    {
+        return liberror::make_error("Catalog pack is corrupted.");
+    }
+
+    m_layout = {
+        .layerCapacity = header.layerCapacity,
+        .layersOffset = header.layersOffset,
+        .entriesOffset = header.entriesOffset,
+        .entryCount = header.entryCount,
+        .stringsOffset = header.stringsOffset,
+        .stringsSize = header.stringsSize,
+        .blobOffset = header.blobOffset,
+        .blobSize = header.blobSize,
+        .programsOffset = header.programsOffset,
+        .programsSize = header.programsSize
+    };
+
+    if (!is_consistent())
+    {
+        return liberror::make_error("Catalog pack is corrupted.");
+    }
+
+    m_catalog = TRY(Catalog::make(std::move(languages)));
+
+    return {};
+}
+
+Pack::Pack(Pack&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+Pack& Pack::operator=(Pack&& other) noexcept
+{
+    if (this == &other) return *this;
+
+    if (m_mapped) ::munmap(const_cast<char*>(m_data), m_size);
+
+    m_dataPath = std::move(other.m_dataPath);
+    m_image = std::move(other.m_image);
+    m_data = other.m_mapped ? other.m_data : m_image.data();
+    m_size = other.m_size;
+    m_mapped = std::exchange(other.m_mapped, false);
+    m_layout = other.m_layout;
+    m_catalog = std::move(other.m_catalog);
+
+    other.m_data = nullptr;
+    other.m_size = 0;
+
+    return *this;
+}
+
+Pack::~Pack()
+{
+    if (m_mapped) ::munmap(const_cast<char*>(m_data), m_size);
+}
+
+std::string_view Pack::bytes(std::uint64_t offset, std::uint64_t size) const
+{
+    return { m_data + offset, static_cast<std::size_t>(size) };
+}
+
+bool Pack::is_consistent() const
+{
+    auto hasFreeSlot = false;
+
+    for (std::uint64_t slot = 0; slot < m_layout.layerCapacity; slot += 1)
+    {
+        LayerRecord layer {};
+        std::memcpy(&layer, m_data + m_layout.layersOffset + slot * sizeof layer, sizeof layer);
+
+        if (layer.nameSize == 0)
+        {
+            hasFreeSlot = true;
+            continue;
+        }
+
+        if (std::uint64_t { layer.nameOffset } + layer.nameSize > m_layout.stringsSize) return false;
+        if (std::uint64_t { layer.firstEntry } + layer.entryCount > m_layout.entryCount) return false;
+    }
+
+    // Looking up a layer that isn't there stops at the first free slot.
+    if (!hasFreeSlot) return false;
+
+    for (std::uint64_t index = 0; index < m_layout.entryCount; index += 1)
+    {
+        EntryRecord entry {};
+        std::memcpy(&entry, m_data + m_layout.entriesOffset + index * sizeof entry, sizeof entry);
+
+        if (std::uint64_t { entry.pathOffset } + entry.pathSize > m_layout.stringsSize) return false;
+        if (entry.contentOffset > m_layout.blobSize || entry.contentSize > m_layout.blobSize - entry.contentOffset) return false;
+        if (std::uint64_t { entry.programOffset } + entry.programSize > m_layout.programsSize) return false;
+    }
+
+    return true;
+}
+
+std::optional<std::vector<PackEntry>> Pack::layer(std::string_view root) const
+{
+    auto const key = hash(root);
+    auto const mask = m_layout.layerCapacity - 1;
+
+    for (auto slot = key & mask;; slot = (slot + 1) & mask)
+    {
+        LayerRecord layer {};
+        std::memcpy(&layer, m_data + m_layout.layersOffset + slot * sizeof layer, sizeof layer);
+
+        if (layer.nameSize == 0) return std::nullopt;
+        if (layer.hash != key || bytes(m_layout.stringsOffset + layer.nameOffset, layer.nameSize) != root) continue;
+
+        std::vector<PackEntry> entries {};
+        entries.reserve(layer.entryCount);
+
+        for (auto index = layer.firstEntry; index < layer.firstEntry + layer.entryCount; index += 1)
+        {
+            EntryRecord entry {};
+            std::memcpy(&entry, m_data + m_layout.entriesOffset + index * sizeof entry, sizeof entry);
+
+            // The programs section is aligned for `Instruction`, so it is used in place.
+            auto const* program = reinterpret_cast<Instruction const*>(m_data + m_layout.programsOffset) + entry.programOffset;
+
+            entries.push_back({
+                .path = bytes(m_layout.stringsOffset + entry.pathOffset, entry.pathSize),
+                .permissions = static_cast<std::filesystem::perms>(entry.permissions),
+                .directory = entry.directory != 0,
+                .verbatim = entry.verbatim != 0,
+                .embedded = entry.embedded != 0,
+                .content = bytes(m_layout.blobOffset + entry.contentOffset, entry.contentSize),
+                .hash = entry.contentHash,
+                .program = { program, entry.programSize }
+            });
+        }
+
+        return entries;
+    }
+}
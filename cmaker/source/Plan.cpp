@@ -0,0 +1,73 @@
+#include "Plan.hpp"
+
+#include "Catalog.hpp"
+#include "Trace.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+std::vector<std::string> collect_layers(Configuration const& configuration, KindGraph const& graph)
+{
+    std::vector<std::string> layers {};
+
+    for (auto const kindIndex : graph.lineage(*graph.find_kind(configuration.kind)))
+    {
+        auto const& kind = graph.kind(kindIndex);
+
+        layers.push_back("templates/" + configuration.type + "/" + kind.name);
+
+        if (!kind.features.has_value()) continue;
+
+        for (auto const& feature : *kind.features)
+        {
+            auto const isRequired = !feature.optional;
+            auto const isPresent = std::ranges::find(configuration.features, feature.name) != configuration.features.end();
+            if (isRequired || isPresent) layers.push_back("features/" + feature.name);
+        }
+    }
+
+    // A feature declared by several kinds of the lineage is stacked where it was last declared.
+    for (auto layer = layers.begin(); layer != layers.end();)
+    {
+        if (std::find(std::next(layer), layers.end(), *layer) != layers.end()) layer = layers.erase(layer);
+        else ++layer;
+    }
+
+    return layers;
+}
+
+Plan make_plan(Pack const& pack, std::vector<std::string> layers, WildcardMatcher const& wildcards)
+{
+    TraceSpan span("plan");
+
+    Plan plan { .layers = std::move(layers), .directories = {}, .files = {} };
+    std::unordered_map<std::string, std::size_t> winners {};
+
+    for (std::size_t layer = 0; layer < plan.layers.size(); layer += 1)
+    {
+        auto const entries = pack.layer(plan.layers[layer]);
+        if (!entries.has_value()) continue;
+
+        for (auto const& entry : *entries)
+        {
+            auto destination = wildcards.replace(entry.path);
+
+            if (entry.directory)
+            {
+                plan.directories.emplace_back(std::move(destination));
+                continue;
+            }
+
+            auto const [winner, isNew] = winners.try_emplace(destination, plan.files.size());
+            if (isNew) plan.files.push_back({ .layer = layer, .entry = entry, .destination = std::move(destination) });
+            else plan.files[winner->second] = { .layer = layer, .entry = entry, .destination = std::move(destination) };
+        }
+    }
+
+    std::ranges::sort(plan.directories);
+    auto const duplicates = std::ranges::unique(plan.directories);
+    plan.directories.erase(duplicates.begin(), duplicates.end());
+    std::ranges::sort(plan.files, {}, &PlannedFile::destination);
+
+    return plan;
+}
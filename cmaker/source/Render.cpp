@@ -0,0 +1,317 @@
+#include "Render.hpp"
+
+#include "FileWriter.hpp"
+#include "Hash.hpp"
+#include "Manifest.hpp"
+#include "Trace.hpp"
+
+#include <fplus/fplus.hpp>
+#include <liberror/Try.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+std::unordered_map<std::string, std::string> make_wildcards(Configuration const& configuration)
+{
+    return {
+        { "!PROJECT!", configuration.name },
+        { "!LANGUAGE!", configuration.language },
+        { "!STANDARD!", configuration.standard }
+    };
+}
+
+// A fresh directory next to `destination`, so that publishing it is a rename within one
+// filesystem.
+liberror::Result<std::filesystem::path> make_staging_directory(std::filesystem::path const& destination)
+{
+    namespace fs = std::filesystem;
+
+    auto const parent = destination.has_parent_path() ? destination.parent_path() : fs::path(".");
+
+    for (auto attempt = 0;; attempt += 1)
+    {
+        auto const staging = parent / fmt::format(".{}.{}-{}.cmaker", destination.filename().string(), ::getpid(), attempt);
+        if (::mkdir(staging.c_str(), 0777) == 0) return staging;
+
+        if (errno != EEXIST)
+        {
+            return liberror::make_error("Couldn't create \"{}\": {}.", staging.string(), std::strerror(errno));
+        }
+    }
+}
+
+// libpreprocessor only reads files, so a template compiled into the executable is handed to it
+// through a temporary copy.
+liberror::Result<std::string> preprocess_embedded(PackEntry const& entry, libpreprocessor::PreprocessorContext const& context)
+{
+    namespace fs = std::filesystem;
+
+    std::error_code error {};
+    auto path = (fs::temp_directory_path(error) / "cmaker.XXXXXX").string();
+    if (error) return liberror::make_error("Couldn't preprocess \"{}\": {}.", entry.path, error.message());
+
+    auto const descriptor = ::mkostemp(path.data(), O_CLOEXEC);
+    if (descriptor == -1) return liberror::make_error("Couldn't preprocess \"{}\": {}.", entry.path, std::strerror(errno));
+
+    auto failure = 0;
+    for (auto content = entry.content; !content.empty() && failure == 0;)
+    {
+        auto const result = ::write(descriptor, content.data(), content.size());
+        if (result == -1 && errno == EINTR) continue;
+        if (result <= 0) failure = result == 0 ? EIO : errno;
+        else content.remove_prefix(static_cast<std::size_t>(result));
+    }
+
+    if (::close(descriptor) != 0 && failure == 0) failure = errno;
+
+    if (failure != 0)
+    {
+        ::unlink(path.c_str());
+        return liberror::make_error("Couldn't preprocess \"{}\": {}.", entry.path, std::strerror(failure));
+    }
+
+    auto processed = libpreprocessor::process(path, context);
+    ::unlink(path.c_str());
+
+    return processed;
+}
+
+}
+
+liberror::Result<std::string_view> PreprocessorCache::process(std::filesystem::path const& source, libpreprocessor::PreprocessorContext const& context)
+{
+    std::vector<std::pair<std::string_view, std::string_view>> variables(context.environmentVariables.begin(), context.environmentVariables.end());
+    std::ranges::sort(variables);
+
+    auto key = source.string();
+    for (auto const& [name, value] : variables)
+    {
+        key.append(1, '\0').append(name).append(1, '=').append(value);
+    }
+
+    {
+        std::scoped_lock lock(m_mutex);
+        if (auto const found = m_outputs.find(key); found != m_outputs.end()) return std::string_view(found->second);
+    }
+
+    auto output = TRY(libpreprocessor::process(source, context));
+
+    std::scoped_lock lock(m_mutex);
+    return std::string_view(m_outputs.try_emplace(std::move(key), std::move(output)).first->second);
+}
+
+RenderContext make_render_context(Configuration const& configuration, RenderOptions const& options)
+{
+    using namespace std::literals;
+
+    return {
+        .preprocessor = {
+            .environmentVariables = {
+                { "ENV:LANGUAGE", configuration.language },
+                { "ENV:STANDARD", configuration.standard },
+                { "ENV:KIND", configuration.type },
+                { "ENV:MODE", configuration.kind },
+                { "ENV:FEATURES", fplus::join(","s, configuration.features) }
+            }
+        },
+        .wildcards = WildcardMatcher(make_wildcards(configuration)),
+        .options = options
+    };
+}
+
+bool needs_preprocessing(std::string_view content)
+{
+    for (auto position = content.find('%'); position != std::string_view::npos; position = content.find('%', position + 1))
+    {
+        auto const lineStart = content.rfind('\n', position);
+        auto const indentationStart = lineStart == std::string_view::npos ? 0 : lineStart + 1;
+        auto const indentation = content.substr(indentationStart, position - indentationStart);
+        if (indentation.find_first_not_of(" \t") == std::string_view::npos) return true;
+    }
+
+    return false;
+}
+
+bool is_verbatim(std::string_view content)
+{
+    static WildcardMatcher const wildcards(make_wildcards({}));
+    return !needs_preprocessing(content) && !wildcards.matches(content);
+}
+
+liberror::Result<std::string> render_content(PackEntry const& entry, std::filesystem::path const& source, RenderContext const& context)
+{
+    if (entry.verbatim) return std::string(entry.content);
+
+    std::string processed {};
+    auto content = entry.content;
+
+    if (needs_preprocessing(content))
+    {
+        TraceSpan span("preprocess", entry.path);
+
+        if (context.options.compiledDirectives && !entry.program.empty())
+        {
+            processed = TRY(run_directives(entry.program, entry.content, context.preprocessor.environmentVariables));
+            content = processed;
+        }
+        else if (entry.embedded)
+        {
+            processed = TRY(preprocess_embedded(entry, context.preprocessor));
+            content = processed;
+        }
+        else if (context.options.preprocessed != nullptr)
+        {
+            content = TRY(context.options.preprocessed->process(source, context.preprocessor));
+        }
+        else
+        {
+            processed = TRY(libpreprocessor::process(source, context.preprocessor));
+            content = processed;
+        }
+    }
+
+    TraceSpan span("substitute", entry.path);
+    span.set_bytes(content.size());
+
+    return context.wildcards.replace(content);
+}
+
+liberror::Result<std::vector<std::uint64_t>> render_plan(Pack const& pack, Plan const& plan, std::filesystem::path const& destination, RenderContext const& context, ThreadPool& pool)
+{
+    namespace fs = std::filesystem;
+
+    TraceSpan span("render plan");
+
+    try
+    {
+        for (auto const& directory : plan.directories) fs::create_directories(destination / directory);
+    }
+    catch (std::exception const& exception)
+    {
+        return liberror::make_error(exception.what());
+    }
+
+    // Everything is rendered in memory first, so the writes can go out as one batch.
+    std::vector<liberror::Result<std::string>> rendered(plan.files.size());
+    std::vector<char> linked(plan.files.size(), false);
+
+    pool.for_each(plan.files.size(), [&] (std::size_t index) {
+        auto const& file = plan.files[index];
+
+        TraceSpan renderSpan("render", file.entry.path);
+        renderSpan.set_bytes(file.entry.content.size());
+
+        if (!file.entry.verbatim)
+        {
+            rendered[index] = render_content(file.entry, plan.source(pack, file), context);
+            return;
+        }
+
+        // A hard link shares the template's inode, permissions included, so editing the generated
+        // file edits the installed template too. That's why linking is opt-in.
+        if (context.options.linkVerbatim)
+        {
+            TraceSpan linkSpan("link", file.entry.path);
+
+            std::error_code error {};
+            fs::create_hard_link(plan.source(pack, file), destination / file.destination, error);
+            linked[index] = !error;
+        }
+    });
+
+    std::vector<std::string> contents(plan.files.size());
+    std::vector<std::uint64_t> outputs {};
+    outputs.reserve(plan.files.size());
+
+    for (std::size_t index = 0; index < plan.files.size(); index += 1)
+    {
+        auto const& file = plan.files[index];
+        if (!file.entry.verbatim) contents[index] = TRY(std::move(rendered[index]));
+        outputs.push_back(file.entry.verbatim ? file.entry.hash : hash(contents[index]));
+    }
+
+    std::vector<FileWrite> writes {};
+    writes.reserve(plan.files.size());
+
+    for (std::size_t index = 0; index < plan.files.size(); index += 1)
+    {
+        if (linked[index]) continue;
+
+        auto const& file = plan.files[index];
+        writes.push_back({
+            .destination = destination / file.destination,
+            .content = file.entry.verbatim ? file.entry.content : std::string_view(contents[index]),
+            .permissions = file.entry.permissions,
+            .source = file.entry.verbatim ? plan.source(pack, file) : fs::path()
+        });
+    }
+
+    auto writer = FileWriter::make(context.options.io);
+    TRY(writer.write(writes, pool));
+
+    return outputs;
+}
+
+liberror::Result<void> generate_project(Pack const& pack, Plan const& plan, Configuration const& configuration, RenderContext const& context, ThreadPool& pool)
+{
+    namespace fs = std::filesystem;
+
+    TraceSpan span("generate");
+
+    fs::path const destination = configuration.name;
+
+    auto const staging = TRY(make_staging_directory(destination));
+
+    auto fnDiscard = [&] {
+        std::error_code error {};
+        fs::remove_all(staging, error);
+    };
+
+    auto const rendered = [&] () -> liberror::Result<void> {
+        auto const outputs = TRY(render_plan(pack, plan, staging, context, pool));
+        TraceSpan manifestSpan("save manifest");
+        TRY(save_manifest(make_manifest(configuration, plan, outputs), staging));
+        return {};
+    }();
+
+    if (!rendered.has_value())
+    {
+        fnDiscard();
+        return rendered;
+    }
+
+    // RENAME_NOREPLACE makes the rename itself the existence check, so two runs racing for the same
+    // name can't end up merged into one directory.
+    TraceSpan publishSpan("publish");
+    auto result = ::renameat2(AT_FDCWD, staging.c_str(), AT_FDCWD, destination.c_str(), RENAME_NOREPLACE);
+
+    // Filesystems without RENAME_NOREPLACE get the check right before the rename instead.
+    if (result == -1 && (errno == EINVAL || errno == ENOSYS))
+    {
+        std::error_code error {};
+        if (fs::exists(destination, error) || error) errno = EEXIST;
+        else result = ::rename(staging.c_str(), destination.c_str());
+    }
+
+    if (result == 0) return {};
+
+    auto const error = errno;
+    fnDiscard();
+
+    if (error == EEXIST)
+    {
+        return liberror::make_error("Project \"{}\" already exists.", destination.string());
+    }
+
+    return liberror::make_error("Couldn't move \"{}\" to \"{}\": {}.", staging.string(), destination.string(), std::strerror(error));
+}
@@ -0,0 +1,16 @@
+#include "Resources.hpp"
+
+// Builds with EMBED_RESOURCES get both from the source generated by cmake/embed_resources.cmake.
+#ifndef EMBED_RESOURCES
+
+std::span<EmbeddedResource const> embedded_resources()
+{
+    return {};
+}
+
+std::uint64_t embedded_resources_stamp()
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,113 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(std::size_t size)
+{
+    size = std::max<std::size_t>(size, 1);
+
+    for (std::size_t worker = 0; worker < size; worker += 1)
+    {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+
+    for (std::size_t worker = 1; worker < size; worker += 1)
+    {
+        m_threads.emplace_back([this, worker] {
+            std::size_t generation = 0;
+
+            while (true)
+            {
+                {
+                    std::unique_lock lock(m_mutex);
+                    m_wakeup.wait(lock, [&] { return m_stopping || m_generation != generation; });
+                    if (m_stopping) return;
+                    generation = m_generation;
+                }
+
+                work(worker);
+            }
+        });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_wakeup.notify_all();
+    m_threads.clear();
+}
+
+void ThreadPool::for_each(std::size_t count, std::function<void(std::size_t)> const& task)
+{
+    if (count == 0) return;
+
+    m_task.store(&task, std::memory_order_release);
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_remaining = count;
+        m_generation += 1;
+    }
+
+    for (std::size_t worker = 0; worker < size(); worker += 1)
+    {
+        auto& queue = *m_queues[worker];
+        std::lock_guard lock(queue.mutex);
+        for (auto index = worker * count / size(); index < (worker + 1) * count / size(); index += 1)
+        {
+            queue.tasks.push_back(index);
+        }
+    }
+
+    m_wakeup.notify_all();
+
+    work(0);
+
+    std::unique_lock lock(m_mutex);
+    m_done.wait(lock, [&] { return m_remaining == 0; });
+    m_task.store(nullptr, std::memory_order_release);
+}
+
+std::optional<std::size_t> ThreadPool::pop(std::size_t worker)
+{
+    {
+        auto& queue = *m_queues[worker];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.tasks.empty())
+        {
+            auto const index = queue.tasks.front();
+            queue.tasks.pop_front();
+            return index;
+        }
+    }
+
+    for (std::size_t offset = 1; offset < size(); offset += 1)
+    {
+        auto& victim = *m_queues[(worker + offset) % size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            auto const index = victim.tasks.back();
+            victim.tasks.pop_back();
+            return index;
+        }
+    }
+
+    return std::nullopt;
+}
+
+void ThreadPool::work(std::size_t worker)
+{
+    while (auto const index = pop(worker))
+    {
+        (*m_task.load(std::memory_order_acquire))(*index);
+
+        std::lock_guard lock(m_mutex);
+        if (--m_remaining == 0) m_done.notify_all();
+    }
+}
@@ -0,0 +1,139 @@
+#include "Trace.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <charconv>
+#include <fstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+Tracer::Tracer() : m_start(std::chrono::steady_clock::now())
+{
+    s_active = this;
+}
+
+Tracer::~Tracer()
+{
+    if (s_active == this) s_active = nullptr;
+}
+
+double Tracer::now() const
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - m_start).count();
+}
+
+void Tracer::record(Event event)
+{
+    std::scoped_lock lock(m_mutex);
+    m_events.push_back(std::move(event));
+}
+
+liberror::Result<void> Tracer::save(std::filesystem::path const& path) const
+{
+    auto events = nlohmann::json::array();
+
+    {
+        std::scoped_lock lock(m_mutex);
+
+        for (auto const& event : m_events)
+        {
+            auto arguments = nlohmann::json::object();
+            if (!event.detail.empty()) arguments["file"] = event.detail;
+            if (event.bytes != 0) arguments["bytes"] = event.bytes;
+            if (event.bytesRead >= 0)
+            {
+                arguments["bytes read"] = event.bytesRead;
+                arguments["bytes written"] = event.bytesWritten;
+                arguments["read calls"] = event.readCalls;
+                arguments["write calls"] = event.writeCalls;
+            }
+
+            events.push_back({
+                { "name", event.name },
+                { "cat", "cmaker" },
+                { "ph", "X" },
+                { "pid", ::getpid() },
+                { "tid", event.thread },
+                { "ts", event.start },
+                { "dur", event.duration },
+                { "args", arguments }
+            });
+        }
+    }
+
+    std::ofstream stream(path, std::ios::trunc);
+    stream << nlohmann::json { { "traceEvents", events }, { "displayTimeUnit", "ms" } }.dump() << '\n';
+
+    if (!stream)
+    {
+        return liberror::make_error("Couldn't write to \"{}\".", path.string());
+    }
+
+    return {};
+}
+
+void TraceSpan::begin()
+{
+    m_overhead = s_overhead;
+    m_counters = sample();
+    m_start = m_tracer->now();
+}
+
+void TraceSpan::end()
+{
+    auto const finish = m_tracer->now();
+    auto const overheadBytes = s_overhead.bytesRead - m_overhead.bytesRead;
+    auto const overheadCalls = s_overhead.readCalls - m_overhead.readCalls;
+    auto const counters = sample();
+    auto const isCounted = m_counters.valid && counters.valid;
+
+    m_tracer->record({
+        .name = m_name,
+        .detail = std::string(m_detail),
+        .thread = ::gettid(),
+        .start = m_start,
+        .duration = finish - m_start,
+        .bytes = m_bytes,
+        .bytesRead = isCounted ? counters.bytesRead - m_counters.bytesRead - overheadBytes : -1,
+        .bytesWritten = isCounted ? counters.bytesWritten - m_counters.bytesWritten : -1,
+        .readCalls = isCounted ? counters.readCalls - m_counters.readCalls - overheadCalls : -1,
+        .writeCalls = isCounted ? counters.writeCalls - m_counters.writeCalls : -1
+    });
+}
+
+TraceSpan::Counters TraceSpan::sample()
+{
+    Counters counters { .bytesRead = 0, .bytesWritten = 0, .readCalls = 0, .writeCalls = 0, .valid = false };
+
+    auto const descriptor = ::open("/proc/thread-self/io", O_RDONLY | O_CLOEXEC);
+    if (descriptor == -1) return counters;
+
+    std::array<char, 512> buffer {};
+    auto const size = ::read(descriptor, buffer.data(), buffer.size());
+    ::close(descriptor);
+    if (size <= 0) return counters;
+
+    // A read shows up in the counters of the next sample, never in its own.
+    s_overhead.bytesRead += size;
+    s_overhead.readCalls += 1;
+
+    std::string_view const content(buffer.data(), static_cast<std::size_t>(size));
+
+    auto fnField = [&] (std::string_view field, std::int64_t& value) {
+        auto const position = content.find(field);
+        if (position == std::string_view::npos) return false;
+        auto const start = content.data() + position + field.size();
+        return std::from_chars(start, content.data() + content.size(), value).ec == std::errc {};
+    };
+
+    auto const isComplete = fnField("rchar: ", counters.bytesRead)
+        && fnField("wchar: ", counters.bytesWritten)
+        && fnField("syscr: ", counters.readCalls)
+        && fnField("syscw: ", counters.writeCalls);
+
+    counters.valid = isComplete;
+
+    return counters;
+}
@@ -0,0 +1,148 @@
+#include "Update.hpp"
+
+#include "Hash.hpp"
+#include "Trace.hpp"
+
+#include <liberror/Try.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <optional>
+
+std::optional<std::uint64_t> hash_file(std::filesystem::path const& path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) return std::nullopt;
+
+    std::string const content(std::istreambuf_iterator<char>(stream), {});
+    return hash(content);
+}
+
+liberror::Result<void> replace_file(std::filesystem::path const& path, std::string_view content, std::filesystem::perms permissions)
+{
+    namespace fs = std::filesystem;
+
+    auto const temporary = fs::path(path).concat(".cmaker.tmp");
+
+    try
+    {
+        fs::create_directories(path.parent_path());
+        {
+            std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+            stream.write(content.data(), static_cast<std::streamsize>(content.size()));
+            if (!stream) return liberror::make_error("Couldn't write to \"{}\".", temporary.string());
+        }
+        fs::permissions(temporary, permissions);
+        fs::rename(temporary, path);
+    }
+    catch (std::exception const& exception)
+    {
+        std::error_code error {};
+        fs::remove(temporary, error);
+        return liberror::make_error(exception.what());
+    }
+
+    return {};
+}
+
+liberror::Result<FileUpdate> update_file(PlannedFile const& file, ManifestFile current, ManifestFile const* recorded, std::filesystem::path const& source, std::filesystem::path const& destination, RenderContext const& context)
+{
+    TraceSpan span("update", file.entry.path);
+    span.set_bytes(file.entry.content.size());
+
+    auto const isCurrent = recorded != nullptr
+        && recorded->source == current.source
+        && recorded->content == current.content
+        && recorded->context == current.context;
+
+    if (isCurrent) return FileUpdate { .outcome = Outcome::UNCHANGED, .record = *recorded };
+
+    // What's on disk has to be what cmaker wrote last time, otherwise it belongs to the user now.
+    auto const existing = hash_file(destination);
+    if (existing.has_value() && (recorded == nullptr || *existing != recorded->output))
+    {
+        return FileUpdate {
+            .outcome = Outcome::SKIPPED,
+            .record = recorded != nullptr ? std::optional(*recorded) : std::nullopt
+        };
+    }
+
+    auto const content = TRY(render_content(file.entry, source, context));
+    current.output = hash(content);
+
+    if (existing == current.output) return FileUpdate { .outcome = Outcome::UNCHANGED, .record = current };
+
+    TRY(replace_file(destination, content, file.entry.permissions));
+
+    return FileUpdate { .outcome = Outcome::UPDATED, .record = current };
+}
+
+liberror::Result<UpdateReport> update_project(Pack const& pack, Plan const& plan, Configuration const& configuration, Manifest const& manifest, std::filesystem::path const& project, RenderContext const& context, ThreadPool& pool)
+{
+    namespace fs = std::filesystem;
+
+    TraceSpan span("update project");
+
+    try
+    {
+        for (auto const& directory : plan.directories) fs::create_directories(project / directory);
+    }
+    catch (std::exception const& exception)
+    {
+        return liberror::make_error(exception.what());
+    }
+
+    auto const contextHash = hash_context(configuration);
+
+    std::vector<liberror::Result<FileUpdate>> results(plan.files.size());
+    pool.for_each(plan.files.size(), [&] (std::size_t index) {
+        auto const& file = plan.files[index];
+        auto const path = file.destination.generic_string();
+        auto const recorded = manifest.files.find(path);
+
+        ManifestFile const current {
+            .source = plan.layers[file.layer] + "/" + std::string(file.entry.path),
+            .context = contextHash,
+            .content = file.entry.hash,
+            .output = 0
+        };
+
+        results[index] = update_file(
+            file,
+            current,
+            recorded != manifest.files.end() ? &recorded->second : nullptr,
+            plan.source(pack, file),
+            project / file.destination,
+            context
+        );
+    });
+
+    UpdateReport report {};
+    Manifest updated { .configuration = configuration, .files = {} };
+    std::optional<std::string> failure {};
+
+    for (std::size_t index = 0; index < results.size(); index += 1)
+    {
+        auto const path = plan.files[index].destination.generic_string();
+        auto const& update = results[index];
+
+        // The files that did get written must still be recorded, or the next update would take
+        // them for files edited by hand. A file that failed keeps its previous record.
+        if (!update.has_value())
+        {
+            if (auto const recorded = manifest.files.find(path); recorded != manifest.files.end()) updated.files[path] = recorded->second;
+            if (!failure.has_value()) failure = update.error().message();
+            continue;
+        }
+
+        if (update->record.has_value()) updated.files[path] = *update->record;
+        if (update->outcome == Outcome::UPDATED) report.updated.push_back(path);
+        if (update->outcome == Outcome::SKIPPED) report.skipped.push_back(path);
+    }
+
+    TRY(save_manifest(updated, project));
+
+    if (failure.has_value()) return liberror::make_error(*failure);
+
+    return report;
+}
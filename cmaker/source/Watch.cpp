@@ -0,0 +1,469 @@
+#include "Watch.hpp"
+
+#include "Directives.hpp"
+#include "Hash.hpp"
+#include "Manifest.hpp"
+#include "Pack.hpp"
+#include "Plan.hpp"
+#include "Trace.hpp"
+#include "Update.hpp"
+
+#include <liberror/Try.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+
+// Saving a file is often several events, e.g. writing a temporary file and renaming it over the
+// original, so events are gathered until none arrived for this long.
+constexpr std::chrono::milliseconds QUIET_PERIOD { 10 };
+
+constexpr std::uint32_t WATCHED_EVENTS = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+struct Source
+{
+    bool directory;
+    // The planned file it provides, unless a later layer provides the same path.
+    std::optional<std::size_t> planned;
+};
+
+struct Session
+{
+    std::optional<Pack> pack;
+    Configuration configuration;
+    RenderContext context;
+    Plan plan;
+    // Every layer and everything in them, relative to the data directory.
+    std::unordered_map<std::string, Source> sources;
+};
+
+struct Changes
+{
+    // Set when the kernel dropped events, which leaves no way to know what changed.
+    bool overflow { false };
+    // Relative to the data directory.
+    std::set<std::string> paths {};
+};
+
+class Inotify
+{
+public:
+    Inotify() : m_descriptor(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {}
+    ~Inotify() { if (m_descriptor != -1) close(m_descriptor); }
+
+    Inotify(Inotify const&) = delete;
+    Inotify& operator=(Inotify const&) = delete;
+
+    bool is_open() const { return m_descriptor != -1; }
+
+    // Watches `directory`, relative to `root`, and with `recursive` every folder under it too.
+    // Watching a folder twice is harmless.
+    liberror::Result<void> watch(std::filesystem::path const& root, std::string const& directory, bool recursive);
+
+    // Blocks until something changed.
+    liberror::Result<Changes> wait();
+
+private:
+    liberror::Result<void> read_events(Changes& changes);
+
+    int m_descriptor { -1 };
+    // Relative to the root they were watched from.
+    std::unordered_map<int, std::string> m_directories {};
+};
+
+liberror::Result<void> Inotify::watch(std::filesystem::path const& root, std::string const& directory, bool recursive)
+{
+    namespace fs = std::filesystem;
+
+    auto fnAdd = [&] (std::string const& relative) -> liberror::Result<void> {
+        auto const path = relative.empty() ? root : root / relative;
+        auto const watch = inotify_add_watch(m_descriptor, path.c_str(), WATCHED_EVENTS | IN_ONLYDIR);
+
+        if (watch == -1)
+        {
+            // A folder found under it gone before it could be watched, which whoever removed it
+            // will have been told about. The directory asked for has to be there though.
+            if (errno == ENOENT && relative != directory) return {};
+            return liberror::make_error("Couldn't watch \"{}\": {}.", path.string(), std::strerror(errno));
+        }
+
+        m_directories[watch] = relative;
+        return {};
+    };
+
+    TRY(fnAdd(directory));
+
+    if (!recursive) return {};
+
+    std::error_code error {};
+    for (auto entry = fs::recursive_directory_iterator(root / directory, error); !error && entry != fs::recursive_directory_iterator(); entry.increment(error))
+    {
+        if (entry->is_directory(error)) TRY(fnAdd(entry->path().lexically_relative(root).generic_string()));
+    }
+
+    return {};
+}
+
+liberror::Result<Changes> Inotify::wait()
+{
+    Changes changes {};
+    auto timeout = -1;
+
+    while (true)
+    {
+        pollfd descriptor { .fd = m_descriptor, .events = POLLIN, .revents = 0 };
+        auto const ready = poll(&descriptor, 1, timeout);
+
+        if (ready == -1)
+        {
+            if (errno == EINTR) continue;
+            return liberror::make_error("Couldn't wait for changes: {}.", std::strerror(errno));
+        }
+
+        if (ready == 0) return changes;
+
+        TRY(read_events(changes));
+        timeout = static_cast<int>(QUIET_PERIOD.count());
+    }
+}
+
+liberror::Result<void> Inotify::read_events(Changes& changes)
+{
+    alignas(inotify_event) std::array<char, 64 * 1024> buffer;
+
+    while (true)
+    {
+        auto const size = read(m_descriptor, buffer.data(), buffer.size());
+
+        if (size == -1)
+        {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN) return {};
+            return liberror::make_error("Couldn't read changes: {}.", std::strerror(errno));
+        }
+
+        for (std::size_t offset = 0; offset < static_cast<std::size_t>(size);)
+        {
+            auto const* event = reinterpret_cast<inotify_event const*>(buffer.data() + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                changes.overflow = true;
+                continue;
+            }
+
+            auto const directory = m_directories.find(event->wd);
+            if (directory == m_directories.end()) continue;
+
+            if (event->mask & IN_IGNORED)
+            {
+                m_directories.erase(directory);
+                continue;
+            }
+
+            // Events about the watched folder itself come without a name.
+            if (event->len == 0)
+            {
+                changes.paths.insert(directory->second);
+                continue;
+            }
+
+            auto const name = std::string(event->name);
+            changes.paths.insert(directory->second.empty() ? name : directory->second + "/" + name);
+        }
+    }
+}
+
+liberror::Result<std::unique_ptr<Session>> open_session(Configuration const& requested, std::filesystem::path const& dataPath, std::filesystem::path const& packPath, RenderOptions const& options)
+{
+    auto session = std::make_unique<Session>();
+
+    // The plan points into the pack, so the pack must not move once it's made.
+    auto pack = TRY(Pack::open(dataPath, packPath));
+    auto const& catalog = session->pack.emplace(std::move(pack)).catalog();
+
+    session->configuration = TRY(configure_project(requested, catalog));
+    session->context = make_render_context(session->configuration, options);
+
+    auto const& graph = *catalog.find_graph(session->configuration.language, session->configuration.type);
+    session->plan = make_plan(*session->pack, collect_layers(session->configuration, graph), session->context.wildcards);
+
+    for (auto const& layer : session->plan.layers)
+    {
+        session->sources[layer] = { .directory = true, .planned = std::nullopt };
+
+        for (auto const& entry : session->pack->layer(layer).value_or(std::vector<PackEntry> {}))
+        {
+            session->sources[layer + "/" + std::string(entry.path)] = { .directory = entry.directory, .planned = std::nullopt };
+        }
+    }
+
+    for (std::size_t index = 0; index < session->plan.files.size(); index += 1)
+    {
+        auto const& file = session->plan.files[index];
+        session->sources[session->plan.layers[file.layer] + "/" + std::string(file.entry.path)].planned = index;
+    }
+
+    return session;
+}
+
+liberror::Result<void> watch_session(Inotify& inotify, Session const& session, std::filesystem::path const& dataPath)
+{
+    // Only for `languages.json`, the layers are watched on their own.
+    TRY(inotify.watch(dataPath, "", false));
+
+    // Features without any files don't have a folder in the data directory.
+    for (auto const& layer : session.plan.layers)
+    {
+        if (session.pack->layer(layer).has_value()) TRY(inotify.watch(dataPath, layer, true));
+    }
+
+    return {};
+}
+
+void print_update(std::string const& path, Outcome outcome)
+{
+    if (outcome == Outcome::UPDATED) fmt::println("updated {}", path);
+    if (outcome == Outcome::SKIPPED) fmt::println("skipped {}, it was changed since it was generated", path);
+}
+
+// Creates the project, or brings it in line with the session and removes the files it no longer
+// plans. Returns the manifest as it was left on disk.
+liberror::Result<Manifest> sync_project(Session const& session, std::filesystem::path const& project, ThreadPool& pool)
+{
+    namespace fs = std::filesystem;
+
+    if (!fs::exists(project))
+    {
+        TRY(generate_project(*session.pack, session.plan, session.configuration, session.context, pool));
+        fmt::println("created {}", project.string());
+        return load_manifest(project);
+    }
+
+    auto const previous = TRY(load_manifest(project));
+    auto const report = TRY(update_project(*session.pack, session.plan, session.configuration, previous, project, session.context, pool));
+
+    for (auto const& path : report.updated) print_update(path, Outcome::UPDATED);
+    for (auto const& path : report.skipped) print_update(path, Outcome::SKIPPED);
+
+    auto manifest = TRY(load_manifest(project));
+
+    for (auto const& [path, recorded] : previous.files)
+    {
+        if (manifest.files.contains(path)) continue;
+
+        if (hash_file(project / path) != recorded.output)
+        {
+            fmt::println("kept {}, it was changed since it was generated", path);
+            continue;
+        }
+
+        std::error_code error {};
+        fs::remove(project / path, error);
+
+        if (error)
+        {
+            return liberror::make_error("Couldn't remove \"{}\": {}.", (project / path).string(), error.message());
+        }
+
+        fmt::println("removed {}", path);
+    }
+
+    return manifest;
+}
+
+// Renders the given planned files again from what their templates hold right now rather than from
+// the pack, which is left stale until the next rebuild.
+liberror::Result<void> refresh_files(Session const& session, std::vector<std::size_t> const& planned, Manifest& manifest, std::filesystem::path const& project, ThreadPool& pool)
+{
+    namespace fs = std::filesystem;
+
+    TraceSpan span("refresh");
+
+    auto const contextHash = hash_context(session.configuration);
+
+    std::vector<liberror::Result<FileUpdate>> results(planned.size());
+    pool.for_each(planned.size(), [&] (std::size_t index) {
+        results[index] = [&] () -> liberror::Result<FileUpdate> {
+            auto file = session.plan.files[planned[index]];
+            auto const source = session.plan.source(*session.pack, file);
+
+            std::ifstream stream(source, std::ios::binary);
+            if (!stream) return liberror::make_error("Couldn't read \"{}\".", source.string());
+            std::string const content(std::istreambuf_iterator<char>(stream), {});
+
+            std::error_code error {};
+            auto const status = fs::status(source, error);
+            if (error) return liberror::make_error("Couldn't read \"{}\": {}.", source.string(), error.message());
+
+            // Everything the pack would have stored for the file.
+            auto const program = needs_preprocessing(content) ? compile_directives(content).value_or(std::vector<Instruction> {}) : std::vector<Instruction> {};
+            file.entry.permissions = status.permissions();
+            file.entry.verbatim = is_verbatim(content);
+            file.entry.embedded = false;
+            file.entry.content = content;
+            file.entry.hash = hash(content);
+            file.entry.program = program;
+
+            auto const recorded = manifest.files.find(file.destination.generic_string());
+            ManifestFile const current {
+                .source = session.plan.layers[file.layer] + "/" + std::string(file.entry.path),
+                .context = contextHash,
+                .content = file.entry.hash,
+                .output = 0
+            };
+
+            return update_file(file, current, recorded != manifest.files.end() ? &recorded->second : nullptr, source, project / file.destination, session.context);
+        }();
+    });
+
+    std::optional<std::string> failure {};
+    auto changed = false;
+
+    for (std::size_t index = 0; index < results.size(); index += 1)
+    {
+        auto const& update = results[index];
+
+        if (!update.has_value())
+        {
+            if (!failure.has_value()) failure = update.error().message();
+            continue;
+        }
+
+        auto const path = session.plan.files[planned[index]].destination.generic_string();
+        print_update(path, update->outcome);
+
+        if (update->record.has_value())
+        {
+            manifest.files[path] = *update->record;
+            changed = true;
+        }
+    }
+
+    if (changed) TRY(save_manifest(manifest, project));
+
+    if (failure.has_value()) return liberror::make_error(*failure);
+
+    return {};
+}
+
+}
+
+liberror::Result<void> watch_project(Configuration const& requested, std::filesystem::path const& dataPath, std::filesystem::path const& packPath, RenderOptions const& options, ThreadPool& pool)
+{
+    namespace fs = std::filesystem;
+    using Clock = std::chrono::steady_clock;
+
+    Inotify inotify {};
+    if (!inotify.is_open())
+    {
+        return liberror::make_error("Couldn't watch for changes: {}.", std::strerror(errno));
+    }
+
+    // Hard links would share files between the preview and the templates being edited.
+    auto watchOptions = options;
+    watchOptions.linkVerbatim = false;
+
+    auto session = TRY(open_session(requested, dataPath, packPath, watchOptions));
+    auto const project = fs::path(session->configuration.name);
+    auto manifest = TRY(sync_project(*session, project, pool));
+    TRY(watch_session(inotify, *session, dataPath));
+
+    fmt::println("watching {} for changes", dataPath.string());
+    std::fflush(stdout);
+
+    while (true)
+    {
+        auto const changes = TRY(inotify.wait());
+        auto const start = Clock::now();
+
+        auto reload = changes.overflow;
+        std::vector<std::size_t> planned {};
+
+        for (auto const& path : changes.paths)
+        {
+            if (path == "languages.json")
+            {
+                reload = true;
+                continue;
+            }
+
+            std::error_code error {};
+            auto const status = fs::status(dataPath / path, error);
+            auto const exists = fs::exists(status);
+            auto const known = session->sources.find(path);
+
+            // Anything new in a layer changes the plan. Files created somewhere else, or created and
+            // removed again before getting here, like the ones editors use to test for write access,
+            // don't.
+            if (known == session->sources.end())
+            {
+                auto const inLayer = std::ranges::any_of(session->plan.layers, [&] (std::string const& layer) {
+                    return path.starts_with(layer + "/");
+                });
+                reload = reload || (exists && inLayer);
+                continue;
+            }
+
+            if (!exists || known->second.directory != fs::is_directory(status))
+            {
+                reload = true;
+                continue;
+            }
+
+            if (known->second.planned.has_value()) planned.push_back(*known->second.planned);
+        }
+
+        if (!reload && planned.empty()) continue;
+
+        auto result = [&] () -> liberror::Result<void> {
+            if (!reload) return refresh_files(*session, planned, manifest, project, pool);
+
+            auto reloaded = TRY(open_session(requested, dataPath, packPath, watchOptions));
+            auto synced = sync_project(*reloaded, project, pool);
+
+            if (!synced.has_value())
+            {
+                // Whatever did get written before the failure was recorded.
+                if (auto current = load_manifest(project); current.has_value()) manifest = std::move(*current);
+                return liberror::make_error(synced.error().message());
+            }
+
+            manifest = std::move(*synced);
+            TRY(watch_session(inotify, *reloaded, dataPath));
+            session = std::move(reloaded);
+            return {};
+        }();
+
+        // A template that doesn't render is something to fix and save again, not a reason to stop.
+        if (!result.has_value())
+        {
+            fmt::println("{}", result.error().message());
+        }
+        else
+        {
+            fmt::println("{} in {:.1f} ms", reload ? "reloaded" : "refreshed", std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+
+        // Output is fully buffered when it isn't a terminal, e.g. when an editor runs this.
+        std::fflush(stdout);
+    }
+}
@@ -0,0 +1,151 @@
+#include "Wildcards.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <queue>
+
+WildcardMatcher::WildcardMatcher(std::unordered_map<std::string, std::string> const& wildcards)
+{
+    for (auto const& [pattern, replacement] : wildcards)
+    {
+        if (pattern.empty()) continue;
+
+        std::uint32_t state = 0;
+        for (auto const character : pattern)
+        {
+            auto const byte = static_cast<unsigned char>(character);
+            if (m_transitions[state][byte] == 0)
+            {
+                m_transitions[state][byte] = static_cast<std::uint32_t>(m_transitions.size());
+                m_transitions.push_back({});
+                m_matches.push_back(NO_MATCH);
+            }
+            state = m_transitions[state][byte];
+        }
+
+        m_matches[state] = static_cast<std::uint32_t>(m_patterns.size());
+        m_patterns.push_back(pattern);
+        m_replacements.push_back(replacement);
+        m_firstBytes[static_cast<unsigned char>(pattern.front())] = true;
+    }
+
+    std::vector<std::uint32_t> failures(m_transitions.size(), 0);
+    std::queue<std::uint32_t> pending {};
+
+    for (auto const next : m_transitions[0])
+    {
+        if (next != 0) pending.push(next);
+    }
+
+    while (!pending.empty())
+    {
+        auto const state = pending.front();
+        pending.pop();
+
+        for (std::size_t character = 0; character < 256; character += 1)
+        {
+            auto& next = m_transitions[state][character];
+            auto const fallback = m_transitions[failures[state]][character];
+
+            if (next == 0)
+            {
+                next = fallback;
+                continue;
+            }
+
+            failures[next] = fallback;
+            if (m_matches[next] == NO_MATCH) m_matches[next] = m_matches[fallback];
+            pending.push(next);
+        }
+    }
+
+    if (std::ranges::count(m_firstBytes, true) == 1)
+    {
+        m_prefilter = static_cast<int>(std::distance(m_firstBytes.begin(), std::ranges::find(m_firstBytes, true)));
+    }
+}
+
+std::size_t WildcardMatcher::skip(std::string_view content, std::size_t position) const
+{
+    if (m_prefilter != -1)
+    {
+        // memchr is vectorized by every libc we care about, and a single leading byte is the common
+        // case since all wildcards look like `!NAME!`.
+        auto const found = std::memchr(content.data() + position, m_prefilter, content.size() - position);
+        return found ? static_cast<std::size_t>(static_cast<char const*>(found) - content.data()) : content.size();
+    }
+
+    while (position < content.size() && !m_firstBytes[static_cast<unsigned char>(content[position])]) position += 1;
+    return position;
+}
+
+std::vector<WildcardMatcher::Match> WildcardMatcher::scan(std::string_view content) const
+{
+    std::vector<Match> matches {};
+    std::uint32_t state = 0;
+
+    for (std::size_t position = 0; position < content.size();)
+    {
+        if (state == 0)
+        {
+            position = skip(content, position);
+            if (position == content.size()) break;
+        }
+
+        state = m_transitions[state][static_cast<unsigned char>(content[position++])];
+
+        if (m_matches[state] != NO_MATCH)
+        {
+            matches.push_back({ position, m_matches[state] });
+            state = 0;
+        }
+    }
+
+    return matches;
+}
+
+bool WildcardMatcher::matches(std::string_view content) const
+{
+    std::uint32_t state = 0;
+
+    for (std::size_t position = 0; position < content.size();)
+    {
+        if (state == 0)
+        {
+            position = skip(content, position);
+            if (position == content.size()) break;
+        }
+
+        state = m_transitions[state][static_cast<unsigned char>(content[position++])];
+        if (m_matches[state] != NO_MATCH) return true;
+    }
+
+    return false;
+}
+
+std::string WildcardMatcher::replace(std::string_view content) const
+{
+    auto const matches = scan(content);
+    if (matches.empty()) return std::string(content);
+
+    auto size = content.size();
+    for (auto const& match : matches)
+    {
+        size = size - m_patterns[match.wildcard].size() + m_replacements[match.wildcard].size();
+    }
+
+    std::string output {};
+    output.reserve(size);
+
+    std::size_t committed = 0;
+    for (auto const& match : matches)
+    {
+        auto const start = match.end - m_patterns[match.wildcard].size();
+        output.append(content.substr(committed, start - committed));
+        output.append(m_replacements[match.wildcard]);
+        committed = match.end;
+    }
+    output.append(content.substr(committed));
+
+    return output;
+}
@@ -0,0 +1,17 @@
+#include <benchmark/benchmark.h>
+
+#include <numeric>
+#include <vector>
+
+static void example(benchmark::State& state)
+{
+    std::vector<int> values(static_cast<std::size_t>(state.range(0)));
+    std::iota(values.begin(), values.end(), 0);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(std::accumulate(values.begin(), values.end(), 0));
+    }
+}
+
+BENCHMARK(example)->Range(8, 8 << 10);
@@ -0,0 +1,21 @@
+function(enable_benchmarks PROJECT)
+    set(!PROJECT!_BenchmarksCompilerOptions ${!PROJECT!_BenchmarksCompilerOptions} ${!PROJECT!_CompilerOptions})
+    set(!PROJECT!_BenchmarksLinkerOptions ${!PROJECT!_BenchmarksLinkerOptions} ${!PROJECT!_LinkerOptions})
+
+    if (ENABLE_NATIVE_ARCH)
+        message(STATUS "[${PROJECT}] benchmarks are built for the host cpu (-march=native).")
+        set(!PROJECT!_BenchmarksCompilerOptions ${!PROJECT!_BenchmarksCompilerOptions} -march=native)
+    endif()
+
+    CPMAddPackage(
+        NAME benchmark
+        GITHUB_REPOSITORY google/benchmark
+        VERSION 1.8.3
+        OPTIONS
+            "BENCHMARK_ENABLE_TESTING OFF"
+            "BENCHMARK_ENABLE_INSTALL OFF"
+            "BENCHMARK_ENABLE_WERROR OFF"
+    )
+
+    add_subdirectory(${PROJECT_SOURCE_DIR}/benchmarks)
+endfunction()
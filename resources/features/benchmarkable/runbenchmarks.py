@@ -0,0 +1,22 @@
+import os
+import sys
+
+def main(arguments):
+    output = "build/results"
+
+    if len(arguments):
+        output = arguments[0]
+
+    os.makedirs(output, exist_ok=True)
+
+    for name in sorted(os.listdir('build/benchmarks/bin')):
+        path = os.path.join('build/benchmarks/bin', name)
+
+        if not os.path.isfile(path) or not os.access(path, os.X_OK):
+            continue
+
+        os.system(f'{path} --benchmark_out={output}/{name}.json --benchmark_out_format=json')
+
+if __name__ == "__main__":
+    sys.argv.pop(0)
+    main(sys.argv)
@@ -0,0 +1,51 @@
+option(ENABLE_UNITY_BUILD "compile the sources of a target in batches" ON)
+set(UNITY_BUILD_BATCH_SIZE 8 CACHE STRING "number of sources compiled together by a unity build")
+option(ENABLE_PRECOMPILED_HEADERS "precompile the headers listed in !PROJECT!_PrecompiledHeaders" ON)
+option(ENABLE_COMPILER_CACHE "use ccache or sccache when available" ON)
+option(ENABLE_FAST_LINKER "link with mold or lld when available" ON)
+
+%IF [<|ENV:LANGUAGE|> EQUALS <c++>]:
+set(FASTBUILD_LANGUAGE CXX)
+%ELSE:
+set(FASTBUILD_LANGUAGE C)
+%END
+
+# The launcher and the linker are picked once for the whole build, dependencies included.
+if (ENABLE_COMPILER_CACHE AND NOT CMAKE_${FASTBUILD_LANGUAGE}_COMPILER_LAUNCHER)
+    find_program(COMPILER_CACHE NAMES ccache sccache)
+
+    if (COMPILER_CACHE)
+        message(STATUS "[${PROJECT_NAME}] compiling through ${COMPILER_CACHE}.")
+        set(CMAKE_${FASTBUILD_LANGUAGE}_COMPILER_LAUNCHER ${COMPILER_CACHE})
+    endif()
+endif()
+
+if (ENABLE_FAST_LINKER AND NOT MSVC)
+    include(CheckLinkerFlag)
+
+    foreach (LINKER mold lld)
+        check_linker_flag(${FASTBUILD_LANGUAGE} "-fuse-ld=${LINKER}" HAS_${LINKER}_LINKER)
+
+        if (HAS_${LINKER}_LINKER)
+            message(STATUS "[${PROJECT_NAME}] linking with ${LINKER}.")
+            add_link_options(-fuse-ld=${LINKER})
+            break()
+        endif()
+    endforeach()
+endif()
+
+function(enable_fastbuild TARGET)
+    get_target_property(TARGET_TYPE ${TARGET} TYPE)
+
+    if (TARGET_TYPE STREQUAL "INTERFACE_LIBRARY")
+        return()
+    endif()
+
+    if (ENABLE_UNITY_BUILD)
+        set_target_properties(${TARGET} PROPERTIES UNITY_BUILD ON UNITY_BUILD_BATCH_SIZE ${UNITY_BUILD_BATCH_SIZE})
+    endif()
+
+    if (ENABLE_PRECOMPILED_HEADERS AND !PROJECT!_PrecompiledHeaders)
+        target_precompile_headers(${TARGET} PRIVATE ${!PROJECT!_PrecompiledHeaders})
+    endif()
+endfunction()
@@ -0,0 +1,38 @@
+function(enable_pgo PROJECT)
+    if (NOT PGO_MODE)
+        return()
+    endif()
+
+%IF [<|ENV:LANGUAGE|> EQUALS <c++>]:
+    set(COMPILER_ID ${CMAKE_CXX_COMPILER_ID})
+%ELSE:
+    set(COMPILER_ID ${CMAKE_C_COMPILER_ID})
+%END
+    set(PGO_DIRECTORY ${CMAKE_BINARY_DIR}/pgo)
+
+    if (COMPILER_ID STREQUAL "GNU")
+        if (PGO_MODE STREQUAL "generate")
+            set(PGO_CompilerOptions -fprofile-generate -fprofile-update=atomic -fprofile-dir=${PGO_DIRECTORY})
+            set(PGO_LinkerOptions -fprofile-generate)
+        else()
+            set(PGO_CompilerOptions -fprofile-use -fprofile-partial-training -fprofile-dir=${PGO_DIRECTORY} -Wno-missing-profile)
+            set(PGO_LinkerOptions -fprofile-use)
+        endif()
+    elseif (COMPILER_ID MATCHES "Clang")
+        if (PGO_MODE STREQUAL "generate")
+            set(PGO_CompilerOptions -fprofile-generate=${PGO_DIRECTORY})
+            set(PGO_LinkerOptions -fprofile-generate=${PGO_DIRECTORY})
+        else()
+            set(PGO_CompilerOptions -fprofile-use=${PGO_DIRECTORY}/default.profdata -Wno-profile-instr-unprofiled -Wno-profile-instr-missing -Wno-profile-instr-out-of-date)
+            set(PGO_LinkerOptions -fprofile-use=${PGO_DIRECTORY}/default.profdata)
+        endif()
+    else()
+        message(WARNING "[${PROJECT}] profile guided optimization isn't supported with ${COMPILER_ID}.")
+        return()
+    endif()
+
+    message(STATUS "[${PROJECT}] profile guided optimization: ${PGO_MODE}, profiles at ${PGO_DIRECTORY}.")
+
+    set(!PROJECT!_CompilerOptions ${!PROJECT!_CompilerOptions} ${PGO_CompilerOptions} PARENT_SCOPE)
+    set(!PROJECT!_LinkerOptions ${!PROJECT!_LinkerOptions} ${PGO_LinkerOptions} PARENT_SCOPE)
+endfunction()
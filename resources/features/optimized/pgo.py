@@ -0,0 +1,41 @@
+import glob
+import os
+import shutil
+import sys
+
+def main(arguments):
+    training = " ".join(arguments)
+
+    if not training:
+%IF [<|ENV:KIND|> EQUALS <executable>]:
+        training = 'build/pgo-generate/!PROJECT!'
+%ELSE:
+    %IF [<|ENV:FEATURES|> CONTAINS <benchmarkable>]:
+        training = 'build/benchmarks/bin/example'
+    %ELSE:
+        print('Pass the command running the training workload, e.g. a program using the library.')
+        return
+    %END
+%END
+
+    shutil.rmtree('build/pgo', ignore_errors=True)
+
+    if os.system('cmake --preset pgo-generate') or os.system('cmake --build build'):
+        return
+
+    if os.system(training):
+        print('The training workload failed.')
+        return
+
+    # GCC updates its profiles in place, clang leaves one raw profile per process to be merged.
+    profiles = glob.glob('build/pgo/*.profraw')
+
+    if len(profiles) and os.system(f'llvm-profdata merge -output=build/pgo/default.profdata { " ".join(profiles) }'):
+        return
+
+    if os.system('cmake --preset pgo-use') == 0:
+        os.system('cmake --build build')
+
+if __name__ == "__main__":
+    sys.argv.pop(0)
+    main(sys.argv)
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <imgui/imgui.hpp>
+
+// A platform and renderer backend that needs neither a window nor a GPU. Frames are built exactly
+// like with the GLFW and OpenGL backends and the draw data is walked but never drawn, so the
+// interface and the profiler overlay can run headlessly, e.g. in CI. Rendering returns the number
+// of indices that would have been drawn.
+bool ImGui_ImplNull_Init(ImVec2 displaySize);
+void ImGui_ImplNull_Shutdown();
+void ImGui_ImplNull_NewFrame(float deltaTime);
+int ImGui_ImplNull_RenderDrawData(ImDrawData const* drawData);
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <liberror/Result.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Number of operator new calls made by the whole program so far.
+std::uint64_t allocation_count();
+
+// Records how long each frame takes, split between building the ImGui frame and rendering it, and
+// how many allocations it makes. The last CAPACITY frames are shown in an overlay, toggled with F3,
+// and can be dumped to CSV.
+class FrameProfiler
+{
+public:
+    static constexpr std::size_t CAPACITY = 512;
+
+    struct Sample
+    {
+        std::uint64_t frame;
+        float frameTime;
+        float buildTime;
+        float renderTime;
+        std::uint64_t allocations;
+    };
+
+    explicit FrameProfiler(std::function<void(bool)> setVsync = {}, bool vsync = true);
+
+    void begin_frame();
+    void begin_render();
+    void end_frame();
+
+    void draw();
+
+    std::vector<Sample> samples() const;
+
+    void write_csv(std::ostream& output) const;
+    liberror::Result<void> write_csv(std::filesystem::path const& path) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::function<void(bool)> m_setVsync {};
+    bool m_vsync { true };
+    bool m_visible { true };
+
+    std::array<Sample, CAPACITY> m_samples {};
+    std::array<float, CAPACITY> m_frameTimes {};
+    std::size_t m_count { 0 };
+    std::uint64_t m_frame { 0 };
+
+    Clock::time_point m_frameStart {};
+    Clock::time_point m_renderStart {};
+    std::uint64_t m_allocationsStart { 0 };
+
+    std::filesystem::path m_csvPath { "frames.csv" };
+    std::string m_csvStatus {};
+};
@@ -0,0 +1,47 @@
+#include "NullBackend.hpp"
+
+bool ImGui_ImplNull_Init(ImVec2 displaySize)
+{
+    auto& io = ImGui::GetIO();
+
+    io.BackendPlatformName = "imgui_impl_null";
+    io.BackendRendererName = "imgui_impl_null";
+    io.DisplaySize = displaySize;
+
+    // The atlas has to be built before the first frame even though it is never uploaded anywhere.
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    return pixels != nullptr;
+}
+
+void ImGui_ImplNull_Shutdown()
+{
+    auto& io = ImGui::GetIO();
+
+    io.BackendPlatformName = nullptr;
+    io.BackendRendererName = nullptr;
+}
+
+void ImGui_ImplNull_NewFrame(float deltaTime)
+{
+    ImGui::GetIO().DeltaTime = deltaTime;
+}
+
+int ImGui_ImplNull_RenderDrawData(ImDrawData const* drawData)
+{
+    // Every command is walked so the part of rendering that doesn't depend on the GPU still shows
+    // up in the profile.
+    int elements = 0;
+
+    for (int list = 0; list < drawData->CmdListsCount; list += 1)
+    {
+        for (auto const& command : drawData->CmdLists[list]->CmdBuffer)
+        {
+            elements += static_cast<int>(command.ElemCount);
+        }
+    }
+
+    return elements;
+}
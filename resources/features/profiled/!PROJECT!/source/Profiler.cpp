@@ -0,0 +1,215 @@
+#include "Profiler.hpp"
+
+#include <imgui/imgui.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+
+namespace {
+
+std::atomic<std::uint64_t> allocations { 0 };
+
+void* allocate(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (auto memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* allocate(std::size_t size, std::align_val_t alignment)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    auto const align = static_cast<std::size_t>(alignment);
+    // aligned_alloc wants the size to be a multiple of the alignment.
+    auto const rounded = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+
+#ifdef _WIN32
+    auto memory = _aligned_malloc(rounded, align);
+#else
+    auto memory = std::aligned_alloc(align, rounded);
+#endif
+
+    if (memory)
+    {
+        return memory;
+    }
+
+    throw std::bad_alloc();
+}
+
+void deallocate(void* memory, std::align_val_t)
+{
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+}
+
+// The nothrow forms call these, so every allocation made through new is counted.
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocate(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocate(size, alignment); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t alignment) noexcept { deallocate(memory, alignment); }
+void operator delete[](void* memory, std::align_val_t alignment) noexcept { deallocate(memory, alignment); }
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept { deallocate(memory, alignment); }
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept { deallocate(memory, alignment); }
+
+std::uint64_t allocation_count()
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+FrameProfiler::FrameProfiler(std::function<void(bool)> setVsync, bool vsync)
+    : m_setVsync(std::move(setVsync))
+    , m_vsync(vsync)
+{
+    if (m_setVsync) m_setVsync(m_vsync);
+}
+
+void FrameProfiler::begin_frame()
+{
+    m_allocationsStart = allocation_count();
+    m_frameStart = Clock::now();
+    m_renderStart = m_frameStart;
+}
+
+void FrameProfiler::begin_render()
+{
+    m_renderStart = Clock::now();
+}
+
+void FrameProfiler::end_frame()
+{
+    auto const now = Clock::now();
+    auto fnMilliseconds = [] (Clock::duration duration) {
+        return std::chrono::duration<float, std::milli>(duration).count();
+    };
+
+    auto const slot = m_frame % CAPACITY;
+    m_samples[slot] = {
+        .frame = m_frame,
+        .frameTime = fnMilliseconds(now - m_frameStart),
+        .buildTime = fnMilliseconds(m_renderStart - m_frameStart),
+        .renderTime = fnMilliseconds(now - m_renderStart),
+        .allocations = allocation_count() - m_allocationsStart
+    };
+    m_frameTimes[slot] = m_samples[slot].frameTime;
+
+    m_frame += 1;
+    m_count = std::min(m_count + 1, CAPACITY);
+}
+
+void FrameProfiler::draw()
+{
+    if (ImGui::IsKeyPressed(ImGuiKey_F3, false)) m_visible = !m_visible;
+    if (!m_visible || m_count == 0) return;
+
+    float frameTotal = 0, buildTotal = 0, renderTotal = 0, frameWorst = 0;
+    for (std::size_t index = 0; index < m_count; index += 1)
+    {
+        frameTotal += m_samples[index].frameTime;
+        buildTotal += m_samples[index].buildTime;
+        renderTotal += m_samples[index].renderTime;
+        frameWorst = std::max(frameWorst, m_samples[index].frameTime);
+    }
+
+    auto const count = static_cast<float>(m_count);
+    auto const frameAverage = frameTotal / count;
+    auto const& latest = m_samples[(m_frame - 1) % CAPACITY];
+
+    auto const* viewport = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos({ viewport->WorkPos.x + viewport->WorkSize.x - 10.f, viewport->WorkPos.y + 10.f }, ImGuiCond_Always, { 1.f, 0.f });
+    ImGui::SetNextWindowBgAlpha(0.75f);
+
+    if (ImGui::Begin("profiler", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav))
+    {
+        ImGui::Text("%.2f ms/frame (%.0f FPS), worst %.2f ms", static_cast<double>(frameAverage), static_cast<double>(1000.f / frameAverage), static_cast<double>(frameWorst));
+
+        // Until the buffer wraps the oldest frame is in the first slot, afterwards it is the one
+        // about to be overwritten.
+        auto const oldest = m_count < CAPACITY ? 0 : static_cast<int>(m_frame % CAPACITY);
+        ImGui::PlotHistogram("##frames", m_frameTimes.data(), static_cast<int>(m_count), oldest, nullptr, 0.f, frameWorst, { 320.f, 80.f });
+
+        ImGui::Text("build %.3f ms, render %.3f ms", static_cast<double>(buildTotal / count), static_cast<double>(renderTotal / count));
+        ImGui::Text("%llu allocations last frame", static_cast<unsigned long long>(latest.allocations));
+
+        if (ImGui::Checkbox("vsync", &m_vsync) && m_setVsync)
+        {
+            m_setVsync(m_vsync);
+        }
+
+        ImGui::SameLine();
+
+        if (ImGui::Button("dump csv"))
+        {
+            auto const result = write_csv(m_csvPath);
+            m_csvStatus = result.has_value() ? "wrote " + m_csvPath.string() : result.error().message();
+        }
+
+        if (!m_csvStatus.empty())
+        {
+            ImGui::TextUnformatted(m_csvStatus.c_str());
+        }
+    }
+    ImGui::End();
+}
+
+std::vector<FrameProfiler::Sample> FrameProfiler::samples() const
+{
+    std::vector<Sample> ordered {};
+    ordered.reserve(m_count);
+
+    for (auto frame = m_frame - m_count; frame < m_frame; frame += 1)
+    {
+        ordered.push_back(m_samples[frame % CAPACITY]);
+    }
+
+    return ordered;
+}
+
+void FrameProfiler::write_csv(std::ostream& output) const
+{
+    output << "frame,frame_ms,build_ms,render_ms,allocations\n";
+
+    for (auto const& sample : samples())
+    {
+        output << sample.frame << ',' << sample.frameTime << ',' << sample.buildTime << ',' << sample.renderTime << ',' << sample.allocations << '\n';
+    }
+}
+
+liberror::Result<void> FrameProfiler::write_csv(std::filesystem::path const& path) const
+{
+    std::ofstream output(path);
+
+    if (!output)
+    {
+        return liberror::make_error("Couldn't open \"{}\".", path.string());
+    }
+
+    write_csv(output);
+
+    if (!output)
+    {
+        return liberror::make_error("Couldn't write \"{}\".", path.string());
+    }
+
+    return {};
+}
@@ -1,11 +1,19 @@
+option(ENABLE_SANITIZERS "build the project and its tests with sanitizers" OFF)
+
 function(enable_tests PROJECT)
     include(GoogleTest)
 
-    if (NOT ${CMAKE_HOST_SYSTEM_NAME} MATCHES "Windows")
-        message(STATUS "[${PROJECT}] running on ${CMAKE_HOST_SYSTEM_NAME}, sanitizers for tests are enabled.")
-        set(!PROJECT!_TestsLinkerOptions ${!PROJECT!_TestsLinkerOptions} -fsanitize=undefined,leak,address)
-    else()
-        message(STATUS "[${PROJECT}] running on ${CMAKE_HOST_SYSTEM_NAME}, sanitizers for tests are disabled.")
+    if (ENABLE_SANITIZERS AND NOT ${CMAKE_HOST_SYSTEM_NAME} MATCHES "Windows")
+        message(STATUS "[${PROJECT}] running on ${CMAKE_HOST_SYSTEM_NAME}, sanitizers are enabled.")
+        set(SANITIZERS -fsanitize=undefined,leak,address -fno-omit-frame-pointer)
+
+        # The project has to be instrumented too, or its bugs go unnoticed by the tests.
+        set(!PROJECT!_CompilerOptions ${!PROJECT!_CompilerOptions} ${SANITIZERS})
+        set(!PROJECT!_LinkerOptions ${!PROJECT!_LinkerOptions} ${SANITIZERS})
+        set(!PROJECT!_CompilerOptions ${!PROJECT!_CompilerOptions} PARENT_SCOPE)
+        set(!PROJECT!_LinkerOptions ${!PROJECT!_LinkerOptions} PARENT_SCOPE)
+    elseif (ENABLE_SANITIZERS)
+        message(STATUS "[${PROJECT}] running on ${CMAKE_HOST_SYSTEM_NAME}, sanitizers are not supported.")
     endif()
 
     set(!PROJECT!_TestsCompilerOptions ${!PROJECT!_TestsCompilerOptions} ${!PROJECT!_CompilerOptions})
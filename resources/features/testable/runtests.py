@@ -1,3 +1,48 @@
 import os
+import subprocess
+import sys
+import xml.etree.ElementTree
 
-os.system('ctest --test-dir build/tests')
+def print_slowest(results, count):
+    if not os.path.exists(results):
+        return
+
+    cases = xml.etree.ElementTree.parse(results).getroot().iter('testcase')
+    timings = sorted(((float(case.get('time', 0)), case.get('name')) for case in cases), reverse=True)
+
+    print("\nSlowest tests:")
+    for time, name in timings[:count]:
+        print(f'{time:8.3f}s {name}')
+
+def main(arguments):
+    jobs = os.cpu_count() or 1
+
+    # CI systems describe shards the way googletest does. Every discovered test is its own ctest
+    # test, so the shard is picked by ctest and the variables must not reach googletest itself.
+    index = int(os.environ.pop('GTEST_SHARD_INDEX', 0))
+    total = int(os.environ.pop('GTEST_TOTAL_SHARDS', 1))
+
+    while len(arguments):
+        argument = arguments.pop(0)
+
+        if argument in ('-j', '--jobs'):
+            jobs = int(arguments.pop(0))
+        elif argument == '--shard':
+            index, total = (int(value) for value in arguments.pop(0).split('/'))
+        else:
+            print(f'Unknown argument {argument}, expected -j <jobs> or --shard <index>/<total>.')
+            return 1
+
+    command = ['ctest', '--test-dir', 'build/tests', '--parallel', str(jobs), '--output-on-failure', '--output-junit', 'results.xml']
+
+    if total > 1:
+        command += ['-I', f'{index + 1},,{total}']
+
+    result = subprocess.run(command).returncode
+    print_slowest('build/tests/results.xml', 10)
+
+    return result
+
+if __name__ == "__main__":
+    sys.argv.pop(0)
+    sys.exit(main(sys.argv))
@@ -3,12 +3,22 @@ import sys
 
 def main(arguments):
     preset = "debug"
+    presets = ["debug", "release"]
+%IF [<|ENV:FEATURES|> CONTAINS <testable>]:
+    presets.append("sanitize")
+%END
+%IF [<|ENV:FEATURES|> CONTAINS <benchmarkable>]:
+    presets.append("bench")
+%END
+%IF [<|ENV:FEATURES|> CONTAINS <optimized>]:
+    presets.extend(["pgo-generate", "pgo-use"])
+%END
 
     if len(arguments) and not arguments[0].startswith("-D"):
         preset = arguments[0].lower()
         arguments.pop(0)
 
-    if preset != "debug" and preset != "release":
+    if preset not in presets:
         print(f'The preset {preset} is invalid.')
         return
 
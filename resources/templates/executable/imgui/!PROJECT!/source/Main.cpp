@@ -5,7 +5,13 @@
 #include <GLFW/glfw3.h>
 #include <liberror/Result.hpp>
 #include <liberror/Try.hpp>
+%IF [<|ENV:FEATURES|> CONTAINS <profiled>]:
 
+#include "NullBackend.hpp"
+#include "Profiler.hpp"
+%END
+
+#include <algorithm>
 #include <iostream>
 #include <ranges>
 #include <span>
@@ -13,8 +19,73 @@
 
 #define NAME "!PROJECT!"
 
+void draw_interface(ImVec2 size)
+{
+    ImGui::SetNextWindowPos({});
+    ImGui::SetNextWindowSize(size);
+    ImGui::Begin(NAME, nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoBringToFrontOnFocus | ImGuiWindowFlags_NoSavedSettings);
+    {
+        // ...
+    }
+    ImGui::End();
+}
+%IF [<|ENV:FEATURES|> CONTAINS <profiled>]:
+
+// Runs the interface without a window through the null backend and dumps the frame times, so the
+// profile can be collected where there is no display.
+liberror::Result<void> run_headless(std::filesystem::path const& csvPath)
+{
+    static constexpr auto HEADLESS_FRAMES = 300;
+
+    IMGUI_CHECKVERSION();
+    ImGui::CreateContext();
+
+    auto& io = ImGui::GetIO();
+
+    io.IniFilename = nullptr;
+    io.LogFilename = nullptr;
+
+    if (!ImGui_ImplNull_Init({ 800.f, 600.f }))
+    {
+        ImGui::DestroyContext();
+        return liberror::make_error("Failed to initialize the null backend");
+    }
+
+    FrameProfiler profiler {};
+
+    for (auto frame = 0; frame < HEADLESS_FRAMES; frame += 1)
+    {
+        profiler.begin_frame();
+
+        ImGui_ImplNull_NewFrame(1.f / 60.f);
+        ImGui::NewFrame();
+
+        draw_interface(io.DisplaySize);
+        profiler.draw();
+
+        ImGui::Render();
+        profiler.begin_render();
+        ImGui_ImplNull_RenderDrawData(ImGui::GetDrawData());
+        profiler.end_frame();
+    }
+
+    ImGui_ImplNull_Shutdown();
+    ImGui::DestroyContext();
+
+    return profiler.write_csv(csvPath);
+}
+%END
+
 liberror::Result<void> safe_main([[maybe_unused]] std::vector<std::string_view> const& arguments)
 {
+%IF [<|ENV:FEATURES|> CONTAINS <profiled>]:
+    if (auto headless = std::ranges::find(arguments, "--headless"); headless != arguments.end())
+    {
+        auto const csvPath = std::next(headless) != arguments.end() ? std::filesystem::path(*std::next(headless)) : std::filesystem::path("frames.csv");
+        return run_headless(csvPath);
+    }
+
+%END
     if (!glfwInit())
     {
         return liberror::make_error("Failed to initialize GLFW");
@@ -36,9 +107,17 @@ liberror::Result<void> safe_main([[maybe_unused]] std::vector<std::string_view>
 
     io.IniFilename = nullptr;
     io.LogFilename = nullptr;
+%IF [<|ENV:FEATURES|> CONTAINS <profiled>]:
+
+    FrameProfiler profiler([] (bool vsync) { glfwSwapInterval(vsync ? 1 : 0); });
+%END
 
     while (!glfwWindowShouldClose(window))
     {
+%IF [<|ENV:FEATURES|> CONTAINS <profiled>]:
+        profiler.begin_frame();
+
+%END
         glClear(GL_COLOR_BUFFER_BIT);
 
         ImGui_ImplOpenGL3_NewFrame();
@@ -47,18 +126,22 @@ liberror::Result<void> safe_main([[maybe_unused]] std::vector<std::string_view>
 
         int windowWidth, windowHeight;
         glfwGetWindowSize(window, &windowWidth, &windowHeight);
-        ImGui::SetNextWindowPos({});
-        ImGui::SetNextWindowSize({ static_cast<float>(windowWidth), static_cast<float>(windowHeight) });
-        ImGui::Begin(NAME, nullptr, ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoBringToFrontOnFocus | ImGuiWindowFlags_NoSavedSettings);
-        {
-            // ...
-        }
-        ImGui::End();
+        draw_interface({ static_cast<float>(windowWidth), static_cast<float>(windowHeight) });
+%IF [<|ENV:FEATURES|> CONTAINS <profiled>]:
+        profiler.draw();
+%END
 
         ImGui::Render();
+%IF [<|ENV:FEATURES|> CONTAINS <profiled>]:
+        profiler.begin_render();
+%END
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
         glfwSwapBuffers(window);
         glfwPollEvents();
+%IF [<|ENV:FEATURES|> CONTAINS <profiled>]:
+
+        profiler.end_frame();
+%END
     }
 
     ImGui_ImplOpenGL3_Shutdown();
@@ -1,10 +1,58 @@
-set(CPM_VERSION v0.42.0)
+set(CPM_VERSION 0.42.0)
 
-file(
-    DOWNLOAD
-    https://github.com/cpm-cmake/CPM.cmake/releases/download/${CPM_VERSION}/CPM.cmake
-    ${CMAKE_SOURCE_DIR}/cmake/CPM.cmake
-)
+# Every project on the machine shares one source cache, so CPM.cmake and the dependencies are
+# downloaded once instead of once per project and build directory.
+if (NOT CPM_SOURCE_CACHE)
+    if (DEFINED ENV{CPM_SOURCE_CACHE})
+        set(CPM_SOURCE_CACHE_DEFAULT $ENV{CPM_SOURCE_CACHE})
+    elseif (WIN32)
+        set(CPM_SOURCE_CACHE_DEFAULT $ENV{LOCALAPPDATA}/CPM)
+    elseif (DEFINED ENV{XDG_CACHE_HOME})
+        set(CPM_SOURCE_CACHE_DEFAULT $ENV{XDG_CACHE_HOME}/CPM)
+    else()
+        set(CPM_SOURCE_CACHE_DEFAULT $ENV{HOME}/.cache/CPM)
+    endif()
 
-include(${CMAKE_SOURCE_DIR}/cmake/CPM.cmake)
+    set(CPM_SOURCE_CACHE ${CPM_SOURCE_CACHE_DEFAULT} CACHE PATH "directory shared by every project to cache CPM and its dependencies" FORCE)
+endif()
 
+option(CPM_OFFLINE "never touch the network, resolve CPM and the dependencies from CPM_SOURCE_CACHE" OFF)
+
+# Forced both ways so that turning the option off again reconnects the build.
+if (CPM_OFFLINE)
+    set(FETCHCONTENT_FULLY_DISCONNECTED ON CACHE BOOL "" FORCE)
+    message(STATUS "[${PROJECT_NAME}] resolving dependencies offline from ${CPM_SOURCE_CACHE}.")
+else()
+    set(FETCHCONTENT_FULLY_DISCONNECTED OFF CACHE BOOL "" FORCE)
+endif()
+
+set(CPM_DOWNLOAD_LOCATION ${CPM_SOURCE_CACHE}/cpm/CPM_${CPM_VERSION}.cmake)
+
+if (NOT EXISTS ${CPM_DOWNLOAD_LOCATION})
+    if (CPM_OFFLINE)
+        message(FATAL_ERROR "[${PROJECT_NAME}] CPM ${CPM_VERSION} is not in ${CPM_SOURCE_CACHE}, configure once online with this directory as CPM_SOURCE_CACHE to populate it.")
+    endif()
+
+    # Downloaded next to its final location and renamed, so projects configuring at the same time
+    # never include a partially written file.
+    string(RANDOM LENGTH 8 CPM_DOWNLOAD_SUFFIX)
+    set(CPM_DOWNLOAD_TEMPORARY ${CPM_DOWNLOAD_LOCATION}.${CPM_DOWNLOAD_SUFFIX})
+
+    file(
+        DOWNLOAD
+        https://github.com/cpm-cmake/CPM.cmake/releases/download/v${CPM_VERSION}/CPM.cmake
+        ${CPM_DOWNLOAD_TEMPORARY}
+        STATUS CPM_DOWNLOAD_STATUS
+    )
+
+    list(GET CPM_DOWNLOAD_STATUS 0 CPM_DOWNLOAD_ERROR)
+
+    if (NOT CPM_DOWNLOAD_ERROR EQUAL 0)
+        file(REMOVE ${CPM_DOWNLOAD_TEMPORARY})
+        message(FATAL_ERROR "[${PROJECT_NAME}] couldn't download CPM ${CPM_VERSION}: ${CPM_DOWNLOAD_STATUS}")
+    endif()
+
+    file(RENAME ${CPM_DOWNLOAD_TEMPORARY} ${CPM_DOWNLOAD_LOCATION})
+endif()
+
+include(${CPM_DOWNLOAD_LOCATION})